@@ -9,13 +9,280 @@
 
 #include <stdlib.h>  // null, rand
 #include <stdbool.h> // bool, true, false
-#include <stdio.h>   // printf
+#include <stdint.h>  // uintptr_t, uint64_t, UINT64_MAX
+#include <stdatomic.h> // atomic_bool, atomic_long
+#include <pthread.h> // pthread_create, pthread_cond_wait
+#include <unistd.h>  // sysconf, ftruncate, pread, close
+#include <string.h>  // memcpy, memcmp, memset
+#include <fcntl.h>   // open
+#include <sys/mman.h> // mmap, munmap, msync
+#include <sys/stat.h> // fstat
+#include <time.h>    // clock_gettime
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
 
 #include "dedalus_explorer.h"
 
 const char *    monome = "Daniel Zhu";
-const bool   debugMode = false ; // Mettre à TRUE si on veut voir le fil d'Ariane
-                                 // et la détection de boucle en mode debug.
+const bool   traceMode = true ;  // Journal binaire des décisions (voir
+const char * tracePath = "theseus.trace"; // `tools/theseus_trace.c`).
+const bool parallelMode      = true; // Répartir les parcours des grands
+const long parallelThreshold = 4096; // arbres (en noeuds) sur tous les coeurs.
+
+long         snapshotInterval = 4096;               // Sauvegarder l'exploration
+const char * snapshotPath     = "theseus.snapshot"; // tous les N pas (0 : jamais).
+
+bool cacheMode = true; // Décider les pas évidents sans l'analyse complète.
+
+// Politique d'exploration : ordre de préférence des directions et procédures
+// menées avant chaque mouvement (réglée par `tools/theseus_tuner.c`).
+struct policy {
+    Move order[4];    // directions essayées, par ordre de préférence
+    bool loopCheck;   // procédure antiboucle (`ariane_looped`)
+    bool ambushCheck; // procédure embuscade (`move_prevent_ambush`)
+};
+
+struct policy policy = { {North, East, South, West}, true, true };
+
+// Parcours répartis (voir la section correspondante)
+void parallel_generate( string const, ExpTree const, ExpTree const, bool * const, size_t * const );
+
+// Sous-arbres entièrement explorés (voir la mémoire de Thésée)
+bool memory_closed( ExpTree const );
+
+// Écriture de bits (voir les sauvegardes)
+void snapshot_put( uint8_t * const, size_t * const, unsigned const, int const );
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs au journal d'événements
+
+ *****************************************************************************/
+
+/* --- JOURNAL D'ÉVÉNEMENTS ---------------------------------------------------
+
+ DESCRIPTION :
+    Pour comprendre un mouvement étrange sans ralentir la partie, chaque
+    décision laisse une trace binaire de quelques octets au lieu d'un
+    affichage : reconstitution du fil, boucle détectée, embuscade, demi-tour
+    imposé, nouvel essai après une embuscade, et le mouvement finalement
+    renvoyé (avec son origine : analyse complète, plan ou cache de
+    décisions). Chaque événement est horodaté par le compteur de cycles.
+    
+    Chaque thread écrit dans son propre anneau de `TRACE_EVENTS` événements
+    (les plus anciens sont écrasés), sans verrou : seul le thread
+    propriétaire y écrit, et il publie le nombre d'événements écrits (`head`)
+    après chaque écriture. Les anneaux ne sont pas recopiés en fin de
+    partie : ils résident directement dans le fichier `tracePath`, projeté
+    en mémoire partagée (`MAP_SHARED`) au premier événement. Le journal
+    survit donc à un arrêt brutal du programme (plantage, signal), le
+    système écrivant lui-même les pages modifiées dans le fichier. L'outil
+    `tools/theseus_trace.c` relit ce fichier et affiche la trace en clair.
+    
+    Sans `tracePath` (NULL), ou si le fichier ne peut être projeté, les
+    anneaux sont gardés en mémoire seulement.
+    
+    Les parcours répartis entre plusieurs coeurs ne tracent rien eux-mêmes :
+    le verdict est tracé par le thread qui les a lancés.
+ 
+ --------------------------------------------------------------------------- */
+
+#define TRACE_EVENTS 4096   // événements gardés par thread (puissance de 2)
+#define TRACE_RINGS  64     // nombre maximal de threads tracés
+#define TRACE_MAGIC  "THTRACE2"
+
+enum trace {TraceDecision, TraceThreadRebuilt, TraceLoopDetected,
+            TraceAmbush, TraceUTurn, TraceRetry};
+
+struct trace_event {
+    uint64_t cycles; // horodatage (compteur de cycles)
+    uint32_t step;   // numéro du pas (appel à `theseus`)
+    uint16_t arg;    // longueur du fil (saturée à 65535) ; pour une
+                     // décision, 1 si elle vient d'un plan, 2 du cache
+    uint8_t  type;   // nature de l'événement (`enum trace`)
+    uint8_t  move;   // mouvement concerné
+};
+
+struct trace_ring {
+    atomic_ulong       head;                 // événements écrits
+    struct trace_event events[TRACE_EVENTS]; // anneau
+};
+
+struct trace_header {
+    char     magic[8];    // TRACE_MAGIC
+    uint32_t rings;       // TRACE_RINGS (les anneaux inutilisés sont vides)
+    uint32_t capacity;    // TRACE_EVENTS
+    uint64_t cyclesStart; // correspondance cycles / temps, au premier
+    uint64_t nsStart;     // événement...
+    uint64_t cyclesEnd;   // ... et au dernier relevé (tous les
+    uint64_t nsEnd;       // TRACE_EVENTS / 4 événements, et en fin de partie)
+};
+
+// Contenu du fichier `tracePath`, projeté tel quel
+struct trace_file {
+    struct trace_header header;
+    struct trace_ring   rings[TRACE_RINGS];
+};
+
+struct trace_file *                traceFile      = NULL;
+pthread_once_t                     traceOnce      = PTHREAD_ONCE_INIT;
+atomic_int                         traceRingCount = 0;
+_Thread_local struct trace_ring *  traceRing      = NULL;
+uint32_t                           traceStep      = 0;
+
+
+
+/* --- HORLOGES ---------------------------------------------------------------
+
+ DESCRIPTION :
+    `trace_cycles` lit le compteur de cycles du processeur (à défaut, une
+    horloge en nanosecondes) ; `trace_ns` lit l'horloge monotone, pour
+    convertir les cycles en temps lors du décodage.
+ 
+ --------------------------------------------------------------------------- */
+
+uint64_t trace_ns( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+
+uint64_t trace_cycles( void ) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return trace_ns();
+#endif
+}
+
+
+
+/* --- CORRESPONDANCE CYCLES / TEMPS ------------------------------------------
+
+ DESCRIPTION :
+    Relève ensemble le compteur de cycles et l'horloge, pour que le décodeur
+    puisse convertir les cycles en temps. Appelée régulièrement pendant la
+    partie, et une dernière fois à la fin du programme.
+ 
+ --------------------------------------------------------------------------- */
+
+void trace_calibrate( void ) {
+    if ( traceFile ) {
+        traceFile->header.cyclesEnd = trace_cycles();
+        traceFile->header.nsEnd     = trace_ns();
+    }
+}
+
+
+
+/* --- OUVERTURE DU JOURNAL ---------------------------------------------------
+
+ DESCRIPTION :
+    Projette le fichier `tracePath` (vidé au préalable) en mémoire partagée
+    et y écrit l'en-tête. Appelée une seule fois, au premier événement.
+ 
+ --------------------------------------------------------------------------- */
+
+void trace_open( void ) {
+    
+    size_t const size = sizeof(struct trace_file);
+    int    const fd   = tracePath ? open( tracePath, O_RDWR | O_CREAT, 0644 ) : -1;
+    void *       data = MAP_FAILED;
+    
+    // Les pages du fichier sont remises à zéro sans être écrites
+    if ( fd >= 0 ) {
+        if ( !ftruncate( fd, 0 ) && !ftruncate( fd, size ) ) {
+            data = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        }
+        close( fd );
+    }
+    
+    if ( data == MAP_FAILED ) {
+        data = mmap( NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+    }
+    
+    if ( data == MAP_FAILED ) {
+        return;
+    }
+    
+    traceFile = data;
+    traceFile->header.rings       = TRACE_RINGS;
+    traceFile->header.capacity    = TRACE_EVENTS;
+    traceFile->header.cyclesStart = trace_cycles();
+    traceFile->header.nsStart     = trace_ns();
+    trace_calibrate();
+    memcpy( traceFile->header.magic, TRACE_MAGIC, sizeof(traceFile->header.magic) );
+    
+    atexit( trace_calibrate );
+}
+
+
+
+/* --- ENREGISTREMENT D'UN ÉVÉNEMENT ------------------------------------------
+
+ DESCRIPTION :
+    Ajoute un événement à l'anneau du thread appelant. Au tout premier
+    événement, le journal est ouvert ; au premier événement du thread, un
+    anneau du journal lui est attribué.
+ 
+ PARAMÈTRES :
+    type (enum trace) : nature de l'événement ;
+    move (Move)       : mouvement concerné ;
+    arg (size_t)      : donnée associée (longueur du fil d'Ariane, ou
+                        origine d'une décision).
+ 
+ --------------------------------------------------------------------------- */
+
+void trace_event(
+    enum trace const type,
+          Move const move,
+        size_t const arg
+) {
+    
+    struct trace_event * event;
+    unsigned long        head;
+    
+    if ( !traceMode ) {
+        return;
+    }
+    
+    if ( !traceRing ) {
+        
+        int const slot = atomic_fetch_add( &traceRingCount, 1 );
+        
+        pthread_once( &traceOnce, trace_open );
+        
+        // Au-delà de TRACE_RINGS threads, l'anneau n'est pas écrit
+        if ( traceFile && slot < TRACE_RINGS ) {
+            traceRing = &(traceFile->rings[slot]);
+        } else {
+            traceRing = calloc( 1, sizeof(struct trace_ring) );
+        }
+    }
+    
+    head  = atomic_load_explicit( &(traceRing->head), memory_order_relaxed );
+    
+    if ( !( head & ( TRACE_EVENTS / 4 - 1 ) ) ) {
+        trace_calibrate();
+    }
+    
+    event = &(traceRing->events[head & ( TRACE_EVENTS - 1 )]);
+    
+    event->cycles = trace_cycles();
+    event->step   = traceStep;
+    event->arg    = arg < 65535 ? arg : 65535;
+    event->type   = type;
+    event->move   = move;
+    
+    atomic_store_explicit( &(traceRing->head), head + 1, memory_order_release );
+}
 
 
 
@@ -134,6 +401,64 @@ void ariane_remove(
 
 
 
+/* --- LIBÉRATION DU FIL D'ARIANE ---------------------------------------------
+
+ DESCRIPTION :
+    Procédure libérant la totalité d'un fil d'Ariane, premier élément compris.
+    
+    
+ PARAMÈTRE :
+    thread (string) : fil d'Ariane à libérer.
+    
+ --------------------------------------------------------------------------- */
+
+void ariane_free(
+    string const thread
+) {
+    
+    while ( thread->next ) {
+        ariane_remove( thread );
+    }
+    
+    free( thread );
+    
+}
+
+
+
+/* --- LONGUEUR DU FIL D'ARIANE ----------------------------------------------
+
+ DESCRIPTION :
+    Fonction qui renvoie le nombre de mouvements d'un fil d'Ariane (l'élément
+    final, qui ne contient aucun mouvement, n'est pas compté).
+    
+    
+ PARAMÈTRE :
+    thread (string) : fil d'Ariane à mesurer.
+ 
+ RETOUR :
+    (size_t)        : nombre de mouvements.
+    
+ --------------------------------------------------------------------------- */
+
+size_t ariane_length(
+    string const thread
+) {
+    
+    size_t length = 0;
+    string tmp    = thread;
+    
+    while ( tmp->next ) {
+        length++;
+        tmp = tmp->next;
+    }
+    
+    return length;
+    
+}
+
+
+
 /* --- CRÉER LE FIL D'ARIANE --------------------------------------------------
 
  DESCRIPTION :
@@ -151,7 +476,9 @@ void ariane_remove(
                       la carte d'exploration ;
     found (bool *)  : booléen transmis par référence, permettant d'annuler
                       toute recherche inutile si Thésée venait à être retrouvé
-                      avant la fin du parcours de la totalité de l'arbre.
+                      avant la fin du parcours de la totalité de l'arbre ;
+    depth (size_t *) : nombre de mouvements insérés dans le fil, tenu à jour
+                      au fil de la recherche (évite de remesurer le fil).
  
  --------------------------------------------------------------------------- */
 
@@ -159,11 +486,14 @@ void ariane_generate(
      string const         thread,
     ExpTree const         tree,
     ExpTree const         pos,
-       bool       * const found // c'est le pointeur que l'on veut constant
-) {                             // et non le booléen.
+       bool       * const found, // pointeur constant, booléen modifiable
+     size_t       * const depth  // pointeur constant, longueur modifiable
+) {
     
-    // Insertion du mouvement stocké dans ce noeud
+    // Insertion du mouvement stocké dans ce noeud (celui de la racine, None,
+    // n'est pas inséré)
     ariane_insert( thread, tree->m );
+    *depth += tree->m != None;
     
     // ------------------------------------------------------------------
     // Thésée a été trouvé, Arrêt de la recherche
@@ -177,34 +507,37 @@ void ariane_generate(
     
     // ------------------------------------------------------------------
     // Parcours simpliste de l'arbre. La recherche récursive se fait à condition
-    // que le sous-noeud existe et que Thésée n'a pas été retrouvé
+    // que le sous-noeud existe, qu'il ne soit pas entièrement exploré (Thésée
+    // n'y retourne jamais, voir `memory_closed`) et que Thésée n'a pas été
+    // retrouvé
     
     else {
         
         // Recherche au Nord
-        if ( !(*found) && tree->north ) {
-            ariane_generate( thread, tree->north, pos, found );
+        if ( !(*found) && tree->north && !memory_closed( tree->north ) ) {
+            ariane_generate( thread, tree->north, pos, found, depth );
         }
         
         // Recherche à l'Est
-        if ( !(*found) && tree->east ) {
-            ariane_generate( thread, tree->east, pos, found );
+        if ( !(*found) && tree->east && !memory_closed( tree->east ) ) {
+            ariane_generate( thread, tree->east, pos, found, depth );
         }
         
         // Recherche au Sud
-        if ( !(*found) && tree->south ) {
-            ariane_generate( thread, tree->south, pos, found );
+        if ( !(*found) && tree->south && !memory_closed( tree->south ) ) {
+            ariane_generate( thread, tree->south, pos, found, depth );
         }
         
         // Recherche à l'Ouest
-        if ( !(*found) && tree->west ) {
-            ariane_generate( thread, tree->west, pos, found );
+        if ( !(*found) && tree->west && !memory_closed( tree->west ) ) {
+            ariane_generate( thread, tree->west, pos, found, depth );
         }
         
         // Si malgré la visite de chaque sous-arbre, Thésée demeure introuvable,
         // on supprime le dernier mouvement de la fil.
         if ( !(*found) ) {
             ariane_remove( thread );
+            *depth -= tree->m != None;
         }
         
     }
@@ -212,67 +545,6 @@ void ariane_generate(
 
 
 
-/* --- AFFICHER FIL D'ARIANE --------------------------------------------------
-
- DESCRIPTION :
-    Affiche le fil d'Ariane. Notez que cette procédure est appelée uniquement
-    lorsque `debugMode` (défini au début du fichier) vaut TRUE.
- 
- 
- PARAMÈTRES :
-    thread (string) : fil d'Ariane à afficher.
- 
- --------------------------------------------------------------------------- */
-
-void ariane_print(
-     string const thread
-) {
-    bool   firstMove = true; // Permet de ne pas afficher de flèche au début
-    string       tmp = thread;
-    
-    printf( "Fil d'Ariane : " );
-    
-    while ( tmp ) {
-        if ( !firstMove ) {
-            printf( " < " );
-        } else {
-            firstMove = false;
-        }
-        
-        switch ( tmp->m ) {
-            case North:
-                printf( "N" );
-                break;
-            
-            case East:
-                printf( "E" );
-                break;
-            
-            case South:
-                printf( "S" );
-                break;
-            
-            case West:
-                printf( "W" );
-                break;
-            
-            case None:
-                printf( "START" );
-                break;
-            
-            default:
-                printf( "?" );
-                break;
-        }
-        
-        tmp = tmp->next;
-    }
-    
-    printf( "\n" );
-}
-
-
-
 /* --- INITIALISATION DU FIL D'ARIANE -----------------------------------------
 
  DESCRIPTION :
@@ -302,7 +574,8 @@ void ariane_init(
     ExpTree const pos
 ) {
     
-    bool found = false;
+    bool   found = false;
+    size_t depth = 0;
     
     // Première position enregistrée manuellement (ne sera pas traitée dans
     // la reconstitution)
@@ -310,12 +583,10 @@ void ariane_init(
     thread->next = NULL;
     
     // Reconstitution du fil d'Ariane à l'aide de l'arbre
-    ariane_generate( thread, tree, pos, &found );
+    parallel_generate( thread, tree, pos, &found, &depth );
     
-    // Affichage (si en mode débug)
-    if ( debugMode ) {
-        ariane_print( thread );
-    }
+    // Journal : fil reconstitué
+    trace_event( TraceThreadRebuilt, None, depth );
 }
 
 
@@ -584,6 +855,53 @@ Move move_opposite( Move const direction ) {
 
 
 
+/* --- ENFANT DANS UNE DIRECTION ----------------------------------------------
+
+ DESCRIPTION :
+    Fonction qui renvoie l'enfant d'un noeud dans la direction indiquée.
+ 
+ PARAMÈTRES :
+    node (ExpTree)   : noeud de l'arbre d'exploration ;
+    direction (Move) : direction de l'enfant recherché.
+ 
+ RETOUR :
+    (ExpTree)        : enfant dans cette direction, NULL s'il n'existe pas.
+ 
+ --------------------------------------------------------------------------- */
+
+ExpTree move_child(
+    ExpTree const node,
+       Move const direction
+) {
+    ExpTree child;
+    
+    switch ( direction ) {
+        case North:
+            child = node->north;
+            break;
+        
+        case East:
+            child = node->east;
+            break;
+        
+        case South:
+            child = node->south;
+            break;
+        
+        case West:
+            child = node->west;
+            break;
+        
+        default:
+            child = NULL;
+            break;
+    }
+    
+    return child;
+}
+
+
+
 /* --- MOUVEMENT ANTI EMBUSCADE - PROCÉDURE AMBUSCADE -------------------------
 
  DESCRIPTION :
@@ -629,7 +947,9 @@ Move move_opposite( Move const direction ) {
                                (différent du vrai fil d'Ariane toutefois) ;
     move (Move)              : prochain mouvement que Thésée s'apprête à faire ;
     isNextMoveATrap (bool *) : booléen indiquant si finalement, il existe une
-                               embuscade.
+                               embuscade ;
+    depth (size_t)           : nombre de mouvements du fil hypothétique
+                               (tracé avec l'embuscade).
 
  --------------------------------------------------------------------------- */
 
@@ -637,7 +957,8 @@ void move_prevent_ambush(
     ExpTree   const tree,
     string    const thread,
     Move      const move,
-    bool    * const isNextMoveATrap
+    bool    * const isNextMoveATrap,
+    size_t    const depth
 ) {
     
     // On est arrivé sur une feuille
@@ -650,18 +971,8 @@ void move_prevent_ambush(
         // référence `isNextMoveATrap` (qui sera traité en dehors de cette
         // procédure)
         if ( ariane_back_to_square_one( thread, move_opposite( move ) ) ) {
-            if ( debugMode ) {
-                printf( "/!\\ PROCÉDURE EMBUSCADE ACTIVÉE -- chemin initialement envisagé : %d\n", move );
-                printf( " EMBUSCADE - " );
-                ariane_print( thread );
-            }
-
+            trace_event( TraceAmbush, move, depth );
             *isNextMoveATrap = true;
-        } else {
-            if ( debugMode ) {
-                printf("           - ");
-                ariane_print( thread );
-            }
         }
     }
     
@@ -671,25 +982,25 @@ void move_prevent_ambush(
         
         if ( tree->north ) {
             ariane_insert( thread, tree->north->m );
-            move_prevent_ambush( tree->north, thread, move, isNextMoveATrap );
+            move_prevent_ambush( tree->north, thread, move, isNextMoveATrap, depth + 1 );
             ariane_remove( thread );
         }
         
         if ( tree->east  ) {
             ariane_insert( thread, tree->east->m );
-            move_prevent_ambush( tree->east , thread, move, isNextMoveATrap );
+            move_prevent_ambush( tree->east , thread, move, isNextMoveATrap, depth + 1 );
             ariane_remove( thread );
         }
         
         if ( tree->south ) {
             ariane_insert( thread, tree->south->m );
-            move_prevent_ambush( tree->south, thread, move, isNextMoveATrap );
+            move_prevent_ambush( tree->south, thread, move, isNextMoveATrap, depth + 1 );
             ariane_remove( thread );
         }
         
         if ( tree->west  ) {
             ariane_insert( thread, tree->west->m );
-            move_prevent_ambush( tree->west , thread, move, isNextMoveATrap );
+            move_prevent_ambush( tree->west , thread, move, isNextMoveATrap, depth + 1 );
             ariane_remove( thread );
         }
         
@@ -700,43 +1011,2834 @@ void move_prevent_ambush(
 
 /******************************************************************************
 
-    Fonction principale pour le choix du prochain mouvement
+    Ensemble de modules relatifs à la mémoire de Thésée
 
  *****************************************************************************/
 
-Move theseus(
-    ExpTree const map,      // current exploration tree
-    ExpTree const pos,      // current position in the map exploration tree
-       bool       north,    // can i go North?
-       bool       east,     // can i go East?
-       bool       south,    // can i go South?
-       bool       west      // can i go West?
-) {
-    
-    /* ------------------------------------------------------------------------
-     * Initialisation et déclaration des variables utiles
-     */
-    
-    // Booléens indiquant (i) si le chemin que la fonction s'apprête à renvoyer
-    // ne mène pas vers un chemin déjà visité/une boucle cachée (voir la
-    // procédure `move_prevent_loop`) ; (ii) si on a choisi de faire demi-tour
-    // (voir la suite du programme)
-    bool nextMoveIsATrap = false
-       , hasTurnedAround = false;
+/* --- FICHES ET MÉMOIRE DE L'EXPLORATEUR -------------------------------------
+
+ DESCRIPTION :
+    L'arbre d'exploration ne connaît ni le parent d'un noeud, ni les murs
+    rencontrés en chaque position. Thésée tient donc, d'un appel à l'autre,
+    une fiche par noeud visité, rangée dans une table de hachage indexée par
+    l'adresse du noeud :
+    
+        - `parent` : fiche du noeud parent (NULL pour la racine) ;
+        - `open`   : directions ouvertes relevées lors de la première visite
+                     (un bit par direction, `1 << North` pour le Nord...) ;
+        - `enter`  : rang d'arrivée du noeud (nombre de fiches existantes
+                     lors de sa première visite) ;
+        - `x`, `y` : coordonnées de la cellule, relatives à la racine ;
+        - `complete` : marque de sous-arbre entièrement exploré.
+    
+    Un noeud est marqué dès que Thésée le quitte vers son parent. Seule
+    garantie : l'exploration étant en profondeur, Thésée n'entre plus jamais
+    dans un noeud marqué, et les parcours l'ignorent. Un noeud marqué peut
+    en revanche garder des directions ouvertes inexplorées (demi-tour imposé
+    par la procédure antiboucle, par exemple) : elles ne le seront plus.
+    
+    La mémoire tient aussi le parcours de Thésée (`route`), tel que l'écrit
+    une sauvegarde (voir le format des sauvegardes) : chaque nouveau noeud y ajoute
+    une descente, chaque noeud marqué une remontée. Elle tient de plus les
+    directions ouvertes du chemin de la racine à Thésée, par profondeur.
+    
+    Les fiches sont de plus rangées dans une seconde table de même taille,
+    indexée par leur cellule (`cells`) : elle indique les cellules déjà
+    connues (voir le cache de décisions) et remplace le parcours de la
+    procédure embuscade (voir `memory_ambush`).
+    
+    La mémoire est rattachée à un arbre (`map`) : si l'arbre change, elle est
+    vidée. Elle n'est fiable (`reliable`) que si chaque nouveau noeud a été
+    vu juste après son parent, c'est-à-dire si `theseus` a été appelée à
+    chaque pas de la partie ; sinon, les liens de parenté sont incomplets et
+    les modules qui en dépendent se désactivent.
     
+ --------------------------------------------------------------------------- */
+
+struct record {
+    ExpTree         node;   // noeud de l'arbre d'exploration (clé)
+    struct record * parent; // fiche du noeud parent
+    unsigned char   open;   // directions ouvertes relevées
+    size_t          enter;  // rang d'arrivée du noeud dans la mémoire
+    int             x, y;   // cellule du noeud (la racine est en 0, 0)
+    bool            complete; // sous-arbre entièrement exploré
+    struct record * bucket; // fiche suivante dans la même case de la table
+    struct record * cell;   // fiche suivante dans la même case de `cells`
+};
+
+struct route {
+    uint8_t       * bits;   // parcours codé (voir les sauvegardes)
+    size_t          length; // longueur du parcours, en bits
+    size_t          size;   // taille de `bits`, en octets
+    size_t          nodes;  // noeuds rencontrés par le parcours
+    unsigned char * opens;  // directions ouvertes du chemin, par profondeur
+    size_t          room;   // taille de `opens`
+    size_t          depth;  // profondeur de Thésée
+    size_t          low;    // plus faible profondeur atteinte depuis la
+                            // dernière sauvegarde
+    bool            broken; // Thésée est sorti du parcours en profondeur
+};
+
+struct memory {
+    ExpTree          map;      // arbre auquel se rapportent les fiches
+    struct record *  last;     // fiche de la position du dernier appel
+    bool             reliable; // liens de parenté complets
+    struct record ** table;    // table de hachage des fiches
+    size_t           capacity; // nombre de cases (puissance de 2)
+    size_t           count;    // nombre de fiches
+    string           plan;     // mouvements planifiés restant à jouer
+    ExpTree          planPos;  // position attendue pour le prochain
+                               // mouvement du plan
+    long             steps;    // nombre d'appels à `theseus` sur cet arbre
+    struct record ** cells;    // fiches indexées par cellule (même taille
+                               // que `table`)
+    struct route     route;    // parcours de Thésée depuis la racine
+    unsigned long    epoch;    // numéro de l'arbre (changé à chaque remise
+                               // à zéro de la mémoire)
+    long             saved;    // appel ayant mené la dernière sauvegarde
+};
+
+struct memory memory = { NULL, NULL, false, NULL, 0, 0, NULL, NULL, 0, NULL,
+                         { NULL, 0, 0, 0, NULL, 0, 0, 0, false }, 0, 0 };
+
+
+
+/* --- CASE D'UN NOEUD DANS LA TABLE ------------------------------------------
+
+ DESCRIPTION :
+    Fonction de hachage multiplicative sur l'adresse du noeud (les bits de
+    poids faible, toujours nuls du fait de l'alignement, sont ignorés).
+ 
+ PARAMÈTRES :
+    node (ExpTree)    : noeud dont on cherche la case ;
+    capacity (size_t) : nombre de cases de la table (puissance de 2).
+ 
+ RETOUR :
+    (size_t)          : indice de la case.
+ 
+ --------------------------------------------------------------------------- */
+
+size_t memory_hash(
+    ExpTree const node,
+     size_t const capacity
+) {
+    return ( ( (uintptr_t) node >> 4 ) * 2654435761u ) & ( capacity - 1 );
+}
+
+
+
+/* --- RECHERCHE D'UNE FICHE --------------------------------------------------
+
+ PARAMÈTRE :
+    node (ExpTree)    : noeud dont on cherche la fiche.
+ 
+ RETOUR :
+    (struct record *) : fiche du noeud, NULL s'il n'a jamais été vu.
+ 
+ --------------------------------------------------------------------------- */
+
+struct record * memory_find(
+    ExpTree const node
+) {
     
-    // Réservation de l'espace mémoire pour (i) le fil d'Ariane ; (ii) un fil
-    // antiboucle (voir procédure `move_prevent_loop`)
-    string const thread     = malloc( sizeof(string) )
-               , loopKiller = malloc( sizeof(string) );
+    struct record * tmp = NULL;
+    
+    if ( memory.capacity ) {
+        tmp = memory.table[ memory_hash( node, memory.capacity ) ];
+        
+        while ( tmp && tmp->node != node ) {
+            tmp = tmp->bucket;
+        }
+    }
+    
+    return tmp;
+}
+
+
+
+/* --- CELLULE VOISINE -------------------------------------------------------
+
+ DESCRIPTION :
+    Procédure déplaçant les coordonnées `x`, `y` d'un pas dans la direction
+    `move` (le Nord augmente `y`, l'Est augmente `x`).
+ 
+ --------------------------------------------------------------------------- */
+
+void memory_step(
+    Move const         move,
+     int       * const x,
+     int       * const y
+) {
+    
+    switch ( move ) {
+        case North: *y += 1; break;
+        case East:  *x += 1; break;
+        case South: *y -= 1; break;
+        case West:  *x -= 1; break;
+        default:             break;
+    }
+}
+
+
+
+/* --- CASE D'UNE CELLULE -----------------------------------------------------
+
+ DESCRIPTION :
+    Fonction de hachage des coordonnées d'une cellule dans la table `cells`.
+ 
+ --------------------------------------------------------------------------- */
+
+size_t memory_cell_hash(
+       int const x,
+       int const y,
+    size_t const capacity
+) {
+    return ( (uint32_t) x * 2654435761u ^ (uint32_t) y * 40503u ) & ( capacity - 1 );
+}
+
+
+
+/* --- AJOUT D'UNE FICHE ------------------------------------------------------
+
+ DESCRIPTION :
+    Crée la fiche d'un noeud et la range dans les deux tables. Les tables
+    doublent de taille dès qu'elles sont remplies aux trois quarts.
+ 
+ PARAMÈTRES :
+    node (ExpTree)           : noeud à ficher ;
+    parent (struct record *) : fiche de son parent (NULL si inconnu) ;
+    open (unsigned char)     : directions ouvertes en ce noeud.
+ 
+ RETOUR :
+    (struct record *)        : fiche créée.
+ 
+ --------------------------------------------------------------------------- */
+
+struct record * memory_add(
+          ExpTree const node,
+    struct record * const parent,
+    unsigned char   const open
+) {
+    
+    struct record * const rec = malloc( sizeof(struct record) );
+    size_t                i;
+    
+    // Agrandissement (et réorganisation) de la table
+    if ( 4 * ( memory.count + 1 ) > 3 * memory.capacity ) {
+        
+        size_t const     capacity = memory.capacity ? 2 * memory.capacity : 1024;
+        struct record ** table    = calloc( capacity, sizeof(struct record *) );
+        struct record ** cells    = calloc( capacity, sizeof(struct record *) );
+        
+        for ( i = 0; i < memory.capacity; i++ ) {
+            while ( memory.table[i] ) {
+                struct record * const tmp = memory.table[i];
+                size_t const          h   = memory_hash( tmp->node, capacity );
+                size_t const          c   = memory_cell_hash( tmp->x, tmp->y, capacity );
+                
+                memory.table[i] = tmp->bucket;
+                tmp->bucket     = table[h];
+                table[h]        = tmp;
+                tmp->cell       = cells[c];
+                cells[c]        = tmp;
+            }
+        }
+        
+        free( memory.table );
+        free( memory.cells );
+        memory.table    = table;
+        memory.cells    = cells;
+        memory.capacity = capacity;
+    }
+    
+    rec->node     = node;
+    rec->parent   = parent;
+    rec->open     = open;
+    rec->enter    = memory.count;
+    rec->x        = parent ? parent->x : 0;
+    rec->y        = parent ? parent->y : 0;
+    rec->complete = false;
+    
+    if ( parent ) {
+        memory_step( node->m, &(rec->x), &(rec->y) );
+    }
+    
+    i                = memory_hash( node, memory.capacity );
+    rec->bucket      = memory.table[i];
+    memory.table[i]  = rec;
+    memory.count    += 1;
+    
+    i                = memory_cell_hash( rec->x, rec->y, memory.capacity );
+    rec->cell        = memory.cells[i];
+    memory.cells[i]  = rec;
+    
+    return rec;
+}
+
+
+
+/* --- OUBLI DE TOUTES LES FICHES ---------------------------------------------
+
+ DESCRIPTION :
+    Libère toutes les fiches et le plan en cours, puis rattache la mémoire
+    (vide) à l'arbre donné.
+ 
+ PARAMÈTRE :
+    map (ExpTree) : nouvel arbre d'exploration.
+ 
+ --------------------------------------------------------------------------- */
+
+void memory_reset(
+    ExpTree const map
+) {
+    
+    size_t i;
+    
+    for ( i = 0; i < memory.capacity; i++ ) {
+        while ( memory.table[i] ) {
+            struct record * const tmp = memory.table[i];
+            memory.table[i] = tmp->bucket;
+            free( tmp );
+        }
+    }
+    
+    if ( memory.plan ) {
+        ariane_free( memory.plan );
+    }
+    
+    free( memory.table );
+    free( memory.cells );
+    free( memory.route.bits );
+    free( memory.route.opens );
+    
+    memset( &(memory.route), 0, sizeof(memory.route) );
+    
+    memory.map      = map;
+    memory.last     = NULL;
+    memory.reliable = true;
+    memory.table    = NULL;
+    memory.cells    = NULL;
+    memory.capacity = 0;
+    memory.count    = 0;
+    memory.plan     = NULL;
+    memory.planPos  = NULL;
+    memory.steps    = 0;
+    memory.epoch   += 1;
+    memory.saved    = 0;
+}
+
+
+
+/* --- ÉCRITURE DANS LE PARCOURS ----------------------------------------------
+
+ DESCRIPTION :
+    Ajoute les `width` bits de poids faible de `value` au parcours, dont la
+    zone double de taille dès qu'elle est pleine.
+ 
+ --------------------------------------------------------------------------- */
+
+void memory_route_put(
+    struct route * const route,
+        unsigned   const value,
+             int   const width
+) {
+    
+    if ( 8 * route->size < route->length + width ) {
+        
+        size_t const size = route->size ? 2 * route->size : 4096;
+        
+        route->bits = realloc( route->bits, size );
+        route->size = size;
+    }
+    
+    snapshot_put( route->bits, &(route->length), value, width );
+}
+
+
+
+/* --- DESCENTE ET REMONTÉE DANS LE PARCOURS ----------------------------------
+
+ DESCRIPTION :
+    `memory_route_start` fait partir le parcours de la racine ;
+    `memory_route_descend` ajoute au parcours l'arrivée de Thésée sur un
+    nouveau noeud, enfant de sa position (`from` étant le mouvement qui a
+    mené à celle-ci, None pour la racine), et empile ses directions
+    ouvertes ; `memory_route_climb` ajoute le retour de Thésée vers le
+    parent de sa position. Le code de chaque pas est donné avec le format
+    des sauvegardes.
+ 
+ PARAMÈTRES :
+    route (struct route *) : parcours ;
+    from (Move)            : mouvement ayant mené à la position actuelle ;
+    move (Move)            : mouvement menant au nouveau noeud ;
+    open (unsigned char)   : directions ouvertes en ce noeud.
+ 
+ --------------------------------------------------------------------------- */
+
+void memory_route_start(
+    struct route  * const route,
+    unsigned char   const open
+) {
+    
+    route->room  = 1024;
+    route->opens = realloc( route->opens, route->room );
+    route->nodes = 1;
+    route->depth = 0;
+    route->low   = 0;
+    route->opens[0] = open;
+}
+
+
+void memory_route_descend(
+    struct route  * const route,
+             Move   const from,
+             Move   const move,
+    unsigned char   const open
+) {
+    
+    if ( from == None ) {
+        memory_route_put( route, move, 2 );
+    } else if ( move == from ) {
+        memory_route_put( route, 1, 2 );
+    } else {
+        
+        // Les deux autres directions, dans l'ordre N, E, S, W
+        Move const first = ( from == North || from == South ) ? East : North;
+        
+        memory_route_put( route, move == first ? 3 : 7, 3 );
+    }
+    
+    if ( route->room < route->depth + 2 ) {
+        route->room  = route->room ? 2 * route->room : 1024;
+        route->opens = realloc( route->opens, route->room );
+    }
+    
+    route->nodes += 1;
+    route->depth += 1;
+    route->opens[route->depth] = open;
+}
+
+
+void memory_route_climb(
+    struct route * const route
+) {
+    
+    memory_route_put( route, 0, 1 );
+    
+    route->depth -= 1;
+    
+    if ( route->depth < route->low ) {
+        route->low = route->depth;
+    }
+}
+
+
+
+/* --- MARQUE D'EXPLORATION TERMINÉE ------------------------------------------
+
+ PARAMÈTRE :
+    rec (struct record *) : fiche du noeud que Thésée vient de quitter.
+ 
+ --------------------------------------------------------------------------- */
+
+void memory_close(
+    struct record * const rec
+) {
+    rec->complete = true;
+}
+
+
+
+/* --- CELLULE CONNUE ---------------------------------------------------------
+
+ PARAMÈTRES :
+    x, y (int) : coordonnées de la cellule, relatives à la racine.
+ 
+ RETOUR :
+    (bool)     : TRUE si un noeud fiché se trouve sur cette cellule.
+ 
+ --------------------------------------------------------------------------- */
+
+bool memory_known(
+    int const x,
+    int const y
+) {
+    
+    struct record const * tmp = NULL;
+    
+    if ( memory.capacity ) {
+        tmp = memory.cells[ memory_cell_hash( x, y, memory.capacity ) ];
+        
+        while ( tmp && !( tmp->x == x && tmp->y == y ) ) {
+            tmp = tmp->cell;
+        }
+    }
+    
+    return tmp;
+}
+
+
+
+/* --- SOUS-ARBRE ENTIÈREMENT EXPLORÉ -----------------------------------------
+
+ PARAMÈTRE :
+    node (ExpTree) : racine du sous-arbre.
+ 
+ RETOUR :
+    (bool)         : TRUE si la mémoire est fiable et que le noeud est marqué.
+ 
+ --------------------------------------------------------------------------- */
+
+bool memory_closed(
+    ExpTree const node
+) {
+    
+    struct record const * rec;
+    
+    if ( !memory.reliable ) {
+        return false;
+    }
+    
+    rec = memory_find( node );
+    return rec && rec->complete;
+}
+
+
+
+/* --- EMBUSCADE PAR LES CELLULES ---------------------------------------------
+
+ DESCRIPTION :
+    Équivalent de `move_prevent_ambush` lorsque la mémoire est fiable : au
+    lieu de parcourir tout le sous-arbre de `rec` pour y chercher une feuille
+    située sur la cellule visée, on consulte les fiches de cette cellule. Un
+    noeud appartient au sous-arbre s'il a été fiché après `rec` (exploration
+    en profondeur), et il est alors nécessairement marqué puisque tous les
+    enfants de la position actuelle ont été quittés.
+ 
+ PARAMÈTRES :
+    rec (struct record *) : fiche de la position actuelle ;
+    move (Move)           : prochain mouvement que Thésée s'apprête à faire.
+ 
+ RETOUR :
+    (bool)                : TRUE en cas d'embuscade.
+ 
+ --------------------------------------------------------------------------- */
+
+bool memory_ambush(
+    struct record const * const rec,
+                   Move   const move
+) {
+    
+    struct record const * tmp;
+    int                   x = rec->x
+                        , y = rec->y;
+    ExpTree               node;
+    
+    memory_step( move, &x, &y );
+    
+    for ( tmp = memory.cells[ memory_cell_hash( x, y, memory.capacity ) ];
+          tmp;
+          tmp = tmp->cell ) {
+        
+        node = tmp->node;
+        
+        if (   tmp->x == x && tmp->y == y && tmp->enter > rec->enter
+            && !( node->north || node->east || node->south || node->west ) ) {
+            trace_event( TraceAmbush, move, 0 );
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+
+
+/* --- MISE À JOUR DE LA MÉMOIRE ----------------------------------------------
+
+ DESCRIPTION :
+    Procédure appelée à chaque pas : elle fiche la position actuelle si elle
+    est nouvelle, en la rattachant à la position du pas précédent dont elle
+    doit être un enfant. Un noeud nouveau qui n'est pas un enfant de la
+    position précédente rend la mémoire non fiable.
+    
+    Si Thésée est au contraire remonté vers un ancêtre (un pas, ou plusieurs
+    lorsque le programme appelant a joué une séquence de `theseus_plan`),
+    chaque noeud quitté en chemin est marqué comme entièrement exploré.
+ 
+ PARAMÈTRES :
+    map (ExpTree)                 : arbre d'exploration ;
+    pos (ExpTree)                 : position actuelle de Thésée ;
+    north, east, south, west (bool) : directions accessibles.
+ 
+ --------------------------------------------------------------------------- */
+
+void memory_sync(
+    ExpTree const map,
+    ExpTree const pos,
+       bool const north,
+       bool const east,
+       bool const south,
+       bool const west
+) {
+    
+    struct record * rec;
+    struct record * parent = memory.last;
+    
+    if ( map != memory.map ) {
+        memory_reset( map );
+        parent = NULL;
+    }
+    
+    rec = memory_find( pos );
+    
+    if ( rec && parent && memory.reliable && rec->enter < parent->enter ) {
+        
+        struct record * tmp = parent;
+        
+        while ( tmp && tmp != rec ) {
+            tmp = tmp->parent;
+        }
+        
+        for ( ; tmp && parent != rec; parent = parent->parent ) {
+            memory_close( parent );
+            memory_route_climb( &(memory.route) );
+        }
+        
+        memory.route.broken = memory.route.broken || !tmp;
+    } else if ( rec && rec != parent ) {
+        memory.route.broken = true;
+    }
+    
+    if ( !rec ) {
+        
+        if (   !parent
+            || !(   parent->node->north == pos
+                 || parent->node->east  == pos
+                 || parent->node->south == pos
+                 || parent->node->west  == pos )
+           ) {
+            parent = NULL;
+            memory.reliable = memory.reliable && pos == map;
+        }
+        
+        rec = memory_add( pos, parent,   north << North
+                                       | east  << East
+                                       | south << South
+                                       | west  << West );
+        
+        if ( parent ) {
+            memory_route_descend( &(memory.route), parent->node->m, pos->m, rec->open );
+        } else if ( memory.count == 1 ) {
+            memory_route_start( &(memory.route), rec->open );
+        }
+    }
+    
+    memory.last = rec;
+}
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs aux plans de mouvements
+
+ *****************************************************************************/
+
+/* --- NOEUD ENTIÈREMENT EXPLORÉ ----------------------------------------------
+
+ DESCRIPTION :
+    Fonction indiquant si, en revenant sur ce noeud, `theseus` ne pourrait
+    que faire demi-tour : chaque direction ouverte relevée mène soit vers un
+    enfant déjà exploré, soit vers le parent.
+ 
+ PARAMÈTRE :
+    rec (struct record *) : fiche du noeud.
+ 
+ RETOUR :
+    (bool)                : TRUE si le noeud n'offre plus aucun choix.
+ 
+ --------------------------------------------------------------------------- */
+
+bool plan_dead_end(
+    struct record const * const rec
+) {
+    
+    ExpTree const node = rec->node;
+    
+    return    ( !( rec->open & 1 << North ) || node->north || node->m == South )
+           && ( !( rec->open & 1 << East  ) || node->east  || node->m == West  )
+           && ( !( rec->open & 1 << South ) || node->south || node->m == North )
+           && ( !( rec->open & 1 << West  ) || node->west  || node->m == East  );
+}
+
+
+
+/* --- PLANIFICATION D'UN RETOUR EN ARRIÈRE -----------------------------------
+
+ DESCRIPTION :
+    Lorsque Thésée fait demi-tour, les pas suivants sont connus d'avance tant
+    que les ancêtres traversés n'offrent plus aucun choix : il remonte alors
+    vers leur parent, sans qu'aucune vérification (boucle, embuscade) ne soit
+    déclenchée. Cette procédure enregistre ces pas dans `memory.plan`, dans
+    l'ordre où ils seront joués, jusqu'au premier ancêtre qui offre encore un
+    choix (ou jusqu'à la racine), où l'analyse complète reprendra.
+    
+    Le plan n'est établi que si la mémoire est fiable.
+ 
+ PARAMÈTRES :
+    rec (struct record *) : fiche de la position actuelle ;
+    move (Move)           : mouvement qui vient d'être décidé.
+ 
+ --------------------------------------------------------------------------- */
+
+void plan_backtrack(
+    struct record const * const rec,
+    Move                  const move
+) {
+    
+    struct record const * tmp = rec->parent;
+    string                tail;
+    
+    if (   memory.reliable
+        && tmp
+        && move != None
+        && move == move_opposite( rec->node->m )
+       ) {
+        
+        memory.plan       = malloc( sizeof(struct link) );
+        memory.plan->m    = None;
+        memory.plan->next = NULL;
+        memory.planPos    = tmp->node;
+        tail              = memory.plan;
+        
+        // Ajout en queue : le premier élément du plan est le prochain pas
+        while ( tmp->parent && plan_dead_end( tmp ) ) {
+            tail->m          = move_opposite( tmp->node->m );
+            tail->next       = malloc( sizeof(struct link) );
+            tail             = tail->next;
+            tail->m          = None;
+            tail->next       = NULL;
+            tmp              = tmp->parent;
+        }
+        
+        // Plan vide : rien à retenir
+        if ( !(memory.plan->next) ) {
+            ariane_free( memory.plan );
+            memory.plan = NULL;
+        }
+    }
+}
+
+
+
+/* --- PROCHAIN PAS DU PLAN ---------------------------------------------------
+
+ DESCRIPTION :
+    Fonction renvoyant le prochain mouvement du plan en cours, à condition
+    que Thésée soit bien à la position attendue et que ce mouvement ne soit
+    pas contredit par un mur. Dans le cas contraire, le plan est abandonné.
+ 
+ PARAMÈTRES :
+    pos (ExpTree)                   : position actuelle de Thésée ;
+    north, east, south, west (bool) : directions accessibles.
+ 
+ RETOUR :
+    (Move)                          : mouvement planifié, `None` si aucun
+                                      plan ne s'applique.
+ 
+ --------------------------------------------------------------------------- */
+
+Move plan_next(
+    ExpTree const pos,
+       bool const north,
+       bool const east,
+       bool const south,
+       bool const west
+) {
+    
+    Move          move = None;
+    unsigned char open =   north << North
+                         | east  << East
+                         | south << South
+                         | west  << West;
+    
+    if ( memory.plan ) {
+        
+        if (   pos == memory.planPos
+            && open & 1 << memory.plan->m
+           ) {
+            move           = memory.plan->m;
+            memory.planPos = memory.last->parent->node;
+            ariane_remove( memory.plan );
+        }
+        
+        // Plan terminé ou contredit
+        if ( move == None || !(memory.plan->next) ) {
+            ariane_free( memory.plan );
+            memory.plan = NULL;
+        }
+    }
+    
+    return move;
+}
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs aux parcours parallèles
+
+ *****************************************************************************/
+
+/* --- DÉCOUPAGE D'UN GRAND ARBRE EN TÂCHES -----------------------------------
+
+ DESCRIPTION :
+    Sur de très grands arbres, la recherche de Thésée (`ariane_generate`) et
+    la recherche d'embuscade (`move_prevent_ambush`) parcourent des sous-arbres
+    indépendants les uns des autres : on peut les confier à plusieurs coeurs.
+    
+    L'arbre est d'abord découpé, en largeur, depuis la racine du parcours :
+    chaque noeud développé laisse place à ses enfants, jusqu'à avoir vu
+    `parallelThreshold` noeuds. Ce découpage mesure aussi l'arbre : s'il est
+    épuisé avant, l'arbre est trop petit pour être réparti. Les noeuds non
+    développés deviennent des tâches, ainsi que les feuilles rencontrées en
+    chemin (elles comptent pour les embuscades).
+    
+    Chaque tâche est ensuite parcourue avec son propre fil de travail,
+    reconstitué à partir du chemin qui mène de la racine du parcours à la
+    tâche : le fil partagé (`loopKiller`) n'est donc jamais modifié par deux
+    coeurs à la fois. Le drapeau `stop` joue le rôle de `found` et de
+    `isNextMoveATrap` pour l'ensemble des tâches : dès qu'il est levé, les
+    tâches restantes abandonnent leur parcours.
+    
+    Les tâches sont réparties entre le thread appelant et une équipe
+    d'ouvriers (`crew`) lancée une fois pour toutes au premier parcours
+    réparti, qui attend ensuite les parcours suivants.
+ 
+ --------------------------------------------------------------------------- */
+
+struct task {
+    ExpTree node;   // racine du sous-arbre
+    long    parent; // indice de la tâche dont il est l'enfant (-1 : racine)
+};
+
+struct pool {
+    struct task * entries;  // noeuds rencontrés lors du découpage (au plus
+                            // `parallelThreshold + 4`)
+    long        * tasks;    // indices des sous-arbres à parcourir
+    long          count;    // nombre de sous-arbres à parcourir
+    atomic_long   next;     // prochain sous-arbre à distribuer
+    atomic_bool   stop;     // arrêt anticipé de toutes les tâches
+    ExpTree       pos;      // position recherchée (`ariane_generate`)
+    Move          move;     // mouvement envisagé (`move_prevent_ambush`)
+    bool          ambush;   // nature du parcours
+    string        result;   // fil de la tâche ayant retrouvé Thésée
+    size_t        depth;    // nombre de mouvements de ce fil
+};
+
+struct crew {
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;   // un nouveau parcours est à mener
+    pthread_cond_t  done;   // tous les ouvriers ont fini le parcours
+    long            size;   // ouvriers lancés (0 : thread appelant seul)
+    long            busy;   // ouvriers n'ayant pas fini le parcours en cours
+    unsigned long   round;  // numéro du parcours en cours
+    struct pool   * pool;   // parcours en cours
+    bool            hired;  // équipe déjà lancée
+};
+
+struct crew crew = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                     PTHREAD_COND_INITIALIZER, 0, 0, 0, NULL, false };
+pthread_once_t crewOnce = PTHREAD_ONCE_INIT;
+
+
+
+/* --- SOUS-ARBRE ASSEZ GRAND POUR ÊTRE RÉPARTI -------------------------------
+
+ DESCRIPTION :
+    Fonction indiquant si le parcours peut être confié à `parallel_run`, qui
+    mesure lui-même le sous-arbre lors du découpage.
+    
+    Lorsque la mémoire de Thésée est fiable et que le sous-arbre y est fiché,
+    les parcours ignorent les sous-arbres entièrement explorés et ne visitent
+    plus que le chemin actif : ils ne sont jamais répartis.
+ 
+ PARAMÈTRE :
+    tree (ExpTree) : racine du sous-arbre.
+ 
+ RETOUR :
+    (bool)         : TRUE si le parcours peut être réparti.
+ 
+ --------------------------------------------------------------------------- */
+
+bool parallel_worth(
+    ExpTree const tree
+) {
+    return parallelMode && !( memory.reliable && memory_find( tree ) );
+}
+
+
+
+/* --- FIL D'UNE TÂCHE --------------------------------------------------------
+
+ DESCRIPTION :
+    Procédure insérant dans `thread` les mouvements menant de la racine du
+    parcours jusqu'à la tâche `i` (le mouvement de la racine n'est jamais
+    inséré). Si `self` vaut FALSE, le mouvement de la tâche elle-même est
+    omis, comme attendu par `ariane_generate`. Renvoie le nombre de
+    mouvements insérés.
+ 
+ --------------------------------------------------------------------------- */
+
+size_t parallel_prefix(
+    struct task const * const entries,
+    long                const i,
+    string              const thread,
+    bool                const self
+) {
+    
+    size_t depth = 0;
+    
+    if ( entries[i].parent >= 0 ) {
+        depth = parallel_prefix( entries, entries[i].parent, thread, true );
+        
+        if ( self ) {
+            ariane_insert( thread, entries[i].node->m );
+            depth++;
+        }
+    }
+    
+    return depth;
+}
+
+
+
+/* --- RECHERCHE DE THÉSÉE INTERRUPTIBLE --------------------------------------
+
+ DESCRIPTION :
+    Identique à `ariane_generate`, si ce n'est que la recherche s'interrompt
+    dès que le drapeau partagé `stop` est levé par une autre tâche.
+ 
+ --------------------------------------------------------------------------- */
+
+void parallel_generate_task(
+         string         const thread,
+        ExpTree         const tree,
+        ExpTree         const pos,
+           bool       * const found,
+    atomic_bool       * const stop,
+         size_t       * const depth
+) {
+    
+    ariane_insert( thread, tree->m );
+    *depth += 1;
+    
+    if ( tree == pos ) {
+        *found = true;
+    } else {
+        
+        if ( !(*found) && !atomic_load_explicit( stop, memory_order_relaxed ) && tree->north ) {
+            parallel_generate_task( thread, tree->north, pos, found, stop, depth );
+        }
+        
+        if ( !(*found) && !atomic_load_explicit( stop, memory_order_relaxed ) && tree->east ) {
+            parallel_generate_task( thread, tree->east, pos, found, stop, depth );
+        }
+        
+        if ( !(*found) && !atomic_load_explicit( stop, memory_order_relaxed ) && tree->south ) {
+            parallel_generate_task( thread, tree->south, pos, found, stop, depth );
+        }
+        
+        if ( !(*found) && !atomic_load_explicit( stop, memory_order_relaxed ) && tree->west ) {
+            parallel_generate_task( thread, tree->west, pos, found, stop, depth );
+        }
+        
+        if ( !(*found) ) {
+            ariane_remove( thread );
+            *depth -= 1;
+        }
+    }
+}
+
+
+
+/* --- RECHERCHE D'EMBUSCADE INTERRUPTIBLE ------------------------------------
+
+ DESCRIPTION :
+    Identique à `move_prevent_ambush`, si ce n'est que le parcours
+    s'interrompt dès que le drapeau partagé `stop` est levé, et que le
+    résultat est transmis par ce même drapeau.
+ 
+ --------------------------------------------------------------------------- */
+
+void parallel_ambush_task(
+        ExpTree         const tree,
+         string         const thread,
+           Move         const move,
+    atomic_bool       * const stop
+) {
+    
+    if ( atomic_load_explicit( stop, memory_order_relaxed ) ) {
+        return;
+    }
+    
+    if (   !(tree->north)
+        && !(tree->east )
+        && !(tree->south)
+        && !(tree->west )) {
+        
+        if ( ariane_back_to_square_one( thread, move_opposite( move ) ) ) {
+            atomic_store( stop, true );
+        }
+    }
+    
+    else {
+        
+        if ( tree->north ) {
+            ariane_insert( thread, tree->north->m );
+            parallel_ambush_task( tree->north, thread, move, stop );
+            ariane_remove( thread );
+        }
+        
+        if ( tree->east  ) {
+            ariane_insert( thread, tree->east->m );
+            parallel_ambush_task( tree->east , thread, move, stop );
+            ariane_remove( thread );
+        }
+        
+        if ( tree->south ) {
+            ariane_insert( thread, tree->south->m );
+            parallel_ambush_task( tree->south, thread, move, stop );
+            ariane_remove( thread );
+        }
+        
+        if ( tree->west  ) {
+            ariane_insert( thread, tree->west->m );
+            parallel_ambush_task( tree->west , thread, move, stop );
+            ariane_remove( thread );
+        }
+    }
+}
+
+
+
+/* --- OUVRIER ----------------------------------------------------------------
+
+ DESCRIPTION :
+    Boucle exécutée par chaque coeur : tant que le drapeau `stop` n'est pas
+    levé, l'ouvrier prend le prochain sous-arbre non distribué et le parcourt
+    avec son propre fil de travail. Les coeurs ayant fini leurs sous-arbres
+    reprennent donc ceux que les autres n'ont pas encore entamés.
+ 
+ --------------------------------------------------------------------------- */
+
+void * parallel_worker(
+    void * const arg
+) {
+    
+    struct pool * const pool = arg;
+    long                i;
+    
+    while (   !atomic_load( &(pool->stop) )
+           && ( i = atomic_fetch_add( &(pool->next), 1 ) ) < pool->count
+          ) {
+        
+        long const    task    = pool->tasks[i];
+        ExpTree const node    = pool->entries[task].node;
+        string const  scratch = malloc( sizeof(struct link) );
+        bool          found   = false;
+        size_t        depth   = 0;
+        
+        scratch->m    = None;
+        scratch->next = NULL;
+        
+        if ( pool->ambush ) {
+            parallel_prefix( pool->entries, task, scratch, true );
+            parallel_ambush_task( node, scratch, pool->move, &(pool->stop) );
+        } else {
+            depth = parallel_prefix( pool->entries, task, scratch, false );
+            parallel_generate_task( scratch, node, pool->pos, &found, &(pool->stop), &depth );
+            
+            // Thésée ne se trouve que dans un seul sous-arbre
+            if ( found ) {
+                pool->result = scratch;
+                pool->depth  = depth;
+                atomic_store( &(pool->stop), true );
+            }
+        }
+        
+        if ( !found ) {
+            ariane_free( scratch );
+        }
+    }
+    
+    return NULL;
+}
+
+
+
+/* --- MEMBRE DE L'ÉQUIPE ----------------------------------------------------
+
+ DESCRIPTION :
+    Boucle de chaque ouvrier de l'équipe : il attend qu'un nouveau parcours
+    soit lancé (`round`), y participe comme le thread appelant (voir
+    `parallel_worker`), puis signale qu'il a fini.
+ 
+ PARAMÈTRE :
+    arg (void *) : numéro du dernier parcours lancé avant celui de l'ouvrier.
+ 
+ --------------------------------------------------------------------------- */
+
+void * parallel_member(
+    void * const arg
+) {
+    
+    unsigned long round = (unsigned long) (uintptr_t) arg;
+    
+    pthread_mutex_lock( &(crew.lock) );
+    
+    for ( ;; ) {
+        
+        struct pool * pool;
+        
+        while ( crew.round == round ) {
+            pthread_cond_wait( &(crew.wake), &(crew.lock) );
+        }
+        
+        round = crew.round;
+        pool  = crew.pool;
+        pthread_mutex_unlock( &(crew.lock) );
+        
+        parallel_worker( pool );
+        
+        pthread_mutex_lock( &(crew.lock) );
+        
+        if ( --crew.busy == 0 ) {
+            pthread_cond_signal( &(crew.done) );
+        }
+    }
+    
+    return NULL;
+}
+
+
+
+/* --- ÉQUIPE APRÈS UN FORK ---------------------------------------------------
+
+ DESCRIPTION :
+    Les ouvriers ne survivent pas à `fork` : le processus enfant repart sans
+    équipe, qui sera relancée à son premier parcours réparti.
+ 
+ --------------------------------------------------------------------------- */
+
+void parallel_forget( void ) {
+    pthread_mutex_init( &(crew.lock), NULL );
+    pthread_cond_init( &(crew.wake), NULL );
+    pthread_cond_init( &(crew.done), NULL );
+    crew.size  = 0;
+    crew.busy  = 0;
+    crew.hired = false;
+}
+
+
+void parallel_watch_fork( void ) {
+    pthread_atfork( NULL, NULL, parallel_forget );
+}
+
+
+
+/* --- LANCEMENT DE L'ÉQUIPE --------------------------------------------------
+
+ DESCRIPTION :
+    Lance un ouvrier par coeur, le thread appelant excepté. Seuls les
+    ouvriers effectivement créés sont comptés (la création peut échouer,
+    par exemple faute de place pour leur pile de 256 Mo) : si aucun ne l'a
+    été, les parcours sont menés par le thread appelant seul.
+ 
+ --------------------------------------------------------------------------- */
+
+void parallel_hire( void ) {
+    
+    long const     cores = sysconf( _SC_NPROCESSORS_ONLN ) > 1
+                         ? sysconf( _SC_NPROCESSORS_ONLN ) : 1;
+    pthread_attr_t attr;
+    long           i;
+    
+    if ( crew.hired ) {
+        return;
+    }
+    
+    pthread_once( &crewOnce, parallel_watch_fork );
+    crew.hired = true;
+    
+    pthread_attr_init( &attr );
+    pthread_attr_setstacksize( &attr, (size_t) 256 << 20 );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+    
+    for ( i = 1; i < cores; i++ ) {
+        
+        pthread_t worker;
+        
+        if ( !pthread_create( &worker, &attr, parallel_member,
+                              (void *) (uintptr_t) crew.round ) ) {
+            crew.size++;
+        }
+    }
+    
+    pthread_attr_destroy( &attr );
+}
+
+
+
+/* --- PARCOURS RÉPARTI -------------------------------------------------------
+
+ DESCRIPTION :
+    Découpe le sous-arbre `tree` en tâches puis les répartit entre le thread
+    appelant et l'équipe d'ouvriers.
+    
+    Pour la recherche de Thésée, si la position est rencontrée dès le
+    découpage, le fil est directement reconstitué à partir du chemin. Si le
+    découpage a épuisé l'arbre sans la rencontrer, l'arbre est trop petit
+    pour être réparti : rien n'est parcouru, et l'appelant mène le parcours
+    séquentiel (pour la recherche de Thésée, elle est simplement absente).
+    S'il ne reste qu'un seul sous-arbre à parcourir (couloir), le thread
+    appelant le parcourt seul.
+ 
+ PARAMÈTRES :
+    pool (struct pool *) : nature du parcours (`ambush`, `pos`, `move`),
+                           remplie par l'appelant ;
+    tree (ExpTree)       : racine du parcours.
+ 
+ RETOUR :
+    (bool)               : FALSE si l'arbre n'a pas été réparti.
+ 
+ --------------------------------------------------------------------------- */
+
+bool parallel_run(
+    struct pool * const pool,
+        ExpTree   const tree
+) {
+    
+    long const capacity = parallelThreshold + 4;
+    long       count    = 1
+             , head     = 0
+             , leaves   = 0
+             , i;
+    
+    pool->entries = malloc( capacity * sizeof(struct task) );
+    pool->tasks   = malloc( capacity * sizeof(long) );
+    pool->result  = NULL;
+    pool->depth   = 0;
+    atomic_init( &(pool->next), 0 );
+    atomic_init( &(pool->stop), false );
+    
+    pool->entries[0].node   = tree;
+    pool->entries[0].parent = -1;
+    
+    // Découpage en largeur, jusqu'à avoir vu `parallelThreshold` noeuds (les
+    // noeuds non développés forment les tâches)
+    while ( head < count && count < parallelThreshold ) {
+        
+        ExpTree const node = pool->entries[head].node;
+        
+        if ( !(pool->ambush) && node == pool->pos ) {
+            pool->result    = malloc( sizeof(struct link) );
+            pool->result->m    = None;
+            pool->result->next = NULL;
+            pool->depth = parallel_prefix( pool->entries, head, pool->result, true );
+            break;
+        }
+        
+        if ( !(node->north || node->east || node->south || node->west) ) {
+            pool->tasks[leaves++] = head;
+        }
+        
+        if ( node->north ) { pool->entries[count].node = node->north; pool->entries[count++].parent = head; }
+        if ( node->east  ) { pool->entries[count].node = node->east ; pool->entries[count++].parent = head; }
+        if ( node->south ) { pool->entries[count].node = node->south; pool->entries[count++].parent = head; }
+        if ( node->west  ) { pool->entries[count].node = node->west ; pool->entries[count++].parent = head; }
+        
+        head++;
+    }
+    
+    if ( !(pool->result) && head == count ) {
+        free( pool->tasks );
+        free( pool->entries );
+        return false;
+    }
+    
+    if ( !(pool->result) ) {
+        
+        pool->count = leaves;
+        for ( i = head; i < count; i++ ) {
+            pool->tasks[pool->count++] = i;
+        }
+        
+        if ( count - head > 1 ) {
+            parallel_hire();
+        }
+        
+        if ( count - head > 1 && crew.size > 0 ) {
+            
+            pthread_mutex_lock( &(crew.lock) );
+            crew.pool = pool;
+            crew.busy = crew.size;
+            crew.round++;
+            pthread_cond_broadcast( &(crew.wake) );
+            pthread_mutex_unlock( &(crew.lock) );
+            
+            parallel_worker( pool );
+            
+            pthread_mutex_lock( &(crew.lock) );
+            while ( crew.busy > 0 ) {
+                pthread_cond_wait( &(crew.done), &(crew.lock) );
+            }
+            pthread_mutex_unlock( &(crew.lock) );
+            
+        } else {
+            parallel_worker( pool );
+        }
+    }
+    
+    free( pool->tasks );
+    free( pool->entries );
+    return true;
+}
+
+
+
+/* --- CRÉER LE FIL D'ARIANE (VERSION RÉPARTIE) -------------------------------
+
+ DESCRIPTION :
+    Même rôle que `ariane_generate`, dont elle reprend les paramètres : sur
+    un arbre assez grand, la recherche est répartie entre les coeurs, sinon
+    `ariane_generate` est appelée telle quelle. Sur un arbre que le découpage
+    a épuisé sans rencontrer Thésée, il n'y a plus rien à chercher.
+ 
+ --------------------------------------------------------------------------- */
+
+void parallel_generate(
+     string const         thread,
+    ExpTree const         tree,
+    ExpTree const         pos,
+       bool       * const found,
+     size_t       * const depth
+) {
+    
+    struct pool pool;
+    
+    if ( !parallel_worth( tree ) ) {
+        ariane_generate( thread, tree, pos, found, depth );
+        return;
+    }
+    
+    pool.ambush = false;
+    pool.pos    = pos;
+    pool.move   = None;
+    parallel_run( &pool, tree );
+    
+    // Le fil de la tâche gagnante remplace le premier élément de `thread`
+    if ( pool.result ) {
+        thread->m    = pool.result->m;
+        thread->next = pool.result->next;
+        free( pool.result );
+        *found = true;
+        *depth = pool.depth;
+    }
+}
+
+
+
+/* --- MOUVEMENT ANTI EMBUSCADE (VERSION RÉPARTIE) ----------------------------
+
+ DESCRIPTION :
+    Même rôle que `move_prevent_ambush`, dont elle reprend les paramètres :
+    sur un sous-arbre assez grand, la recherche d'embuscade est répartie
+    entre les coeurs, sinon `move_prevent_ambush` est appelée telle quelle
+    (y compris lorsque `parallel_run` juge l'arbre trop petit).
+ 
+ --------------------------------------------------------------------------- */
+
+void parallel_prevent_ambush(
+    ExpTree   const tree,
+    string    const thread,
+    Move      const move,
+    bool    * const isNextMoveATrap,
+    size_t    const depth
+) {
+    
+    struct pool pool;
+    
+    if ( !parallel_worth( tree ) ) {
+        move_prevent_ambush( tree, thread, move, isNextMoveATrap, depth );
+        return;
+    }
+    
+    pool.ambush = true;
+    pool.pos    = NULL;
+    pool.move   = move;
+    
+    if ( !parallel_run( &pool, tree ) ) {
+        move_prevent_ambush( tree, thread, move, isNextMoveATrap, depth );
+        return;
+    }
+    
+    if ( atomic_load( &(pool.stop) ) ) {
+        trace_event( TraceAmbush, move, 0 );
+        *isNextMoveATrap = true;
+    }
+}
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs aux sauvegardes de l'exploration
+
+ *****************************************************************************/
+
+/* --- FORMAT DES SAUVEGARDES -------------------------------------------------
+
+ DESCRIPTION :
+    Une sauvegarde contient l'arbre d'exploration, la position de Thésée et
+    les directions ouvertes relevées sur le chemin qui y mène, sans aucun
+    pointeur. L'arbre est donné par le parcours de Thésée depuis la racine,
+    tel que la mémoire le tient à jour à chaque pas : une descente par
+    nouveau noeud, une remontée par noeud quitté vers son parent. Chaque
+    pas est codé ainsi (bits dans l'ordre de lecture) :
+    
+        - remontée : 0 ;
+        - descente tout droit (même mouvement que celui du parent) : 10 ;
+        - descente vers l'une des deux autres directions (demi-tour exclu) :
+          110 pour la première dans l'ordre N, E, S, W, 111 pour la seconde ;
+        - descente depuis la racine (ni remontée, ni demi-tour) : la
+          direction, sur 2 bits.
+    
+    Un noeud coûte ainsi 2 ou 3 bits à sa création et 1 bit lorsque Thésée
+    le quitte, soit 3 à 4 bits. La position de Thésée est le noeud atteint
+    au bout du parcours.
+    
+    L'exploration étant en profondeur, le parcours ne fait que s'allonger :
+    une sauvegarde n'écrit que les bits ajoutés depuis la précédente, à la
+    suite de ceux déjà écrits. Les directions ouvertes des noeuds du chemin
+    de la racine à Thésée sont écrites à part, par profondeur (4 bits par
+    noeud), et seules celles du chemin qui a changé depuis la dernière
+    écriture sont réécrites. Les autres noeuds ont été quittés par Thésée et
+    n'y reviendront plus : leurs directions ouvertes sont reconstituées à
+    partir de leurs enfants.
+    
+    Le fichier commence par deux emplacements (`struct snapshot`), chacun
+    décrivant un parcours et des directions ouvertes écrits plus loin dans
+    le fichier. Une sauvegarde remplace l'emplacement le plus ancien sans
+    jamais écrire dans ce que décrit l'autre : le parcours commun n'est
+    allongé qu'au-delà de sa longueur, et toute nouvelle zone est placée
+    hors des siennes. Tout est synchronisé sur le disque (`MS_SYNC`) avant
+    que `magic` ne valide l'emplacement. Un arrêt en pleine sauvegarde
+    laisse au pire un emplacement incomplet, et la restauration reprend
+    alors la sauvegarde précédente (celle de plus grande `generation` parmi
+    les valides).
+    
+    Ces écritures et synchronisations sont menées par un thread d'écriture
+    (`writer`), dans le fichier projeté en mémoire (`mmap`) et gardé ouvert
+    d'une sauvegarde à l'autre : `theseus` ne fait que recopier les bits
+    nouveaux, et n'attend le disque que si la sauvegarde précédente n'est
+    pas finie.
+ 
+ --------------------------------------------------------------------------- */
+
+#define SNAPSHOT_MAGIC "THESEUS3"
+#define SNAPSHOT_SLOTS 2
+
+struct snapshot {
+    char     magic[8];   // SNAPSHOT_MAGIC une fois la sauvegarde complète
+    uint64_t generation; // numéro de la sauvegarde (la plus récente gagne)
+    uint64_t steps;      // nombre d'appels à `theseus` déjà menés
+    uint64_t nodes;      // nombre de noeuds de l'arbre
+    uint64_t depth;      // nombre de mouvements de la racine à Thésée
+    uint64_t route;      // début du parcours dans le fichier (en octets)
+    uint64_t length;     // longueur du parcours (en bits)
+    uint64_t routeSize;  // place réservée au parcours (en octets)
+    uint64_t path;       // début des directions ouvertes du chemin
+    uint64_t pathSize;   // place réservée à ces directions (en octets)
+};
+
+struct mapping {
+    char const * path; // fichier projeté
+    int          fd;   // descripteur du fichier (-1 s'il n'est pas ouvert)
+    void       * data; // projection du fichier
+    size_t       size; // taille de la projection
+};
+
+struct mapping snapshotFile = { NULL, -1, NULL, 0 };
+
+// Sauvegarde confiée au thread d'écriture
+struct writer {
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;     // une sauvegarde est à écrire
+    pthread_cond_t  done;     // la sauvegarde a été écrite
+    bool            busy;     // sauvegarde en cours d'écriture
+    bool            failed;   // la dernière écriture a échoué
+    bool            hired;    // lancement du thread déjà tenté
+    bool            running;  // thread effectivement lancé
+    char const    * path;     // fichier de sauvegarde
+    int             slot;     // emplacement à remplacer
+    struct snapshot header;   // nouvel en-tête de cet emplacement
+    uint8_t       * bits;     // octets du parcours à écrire...
+    size_t          from;     // ... à partir de cet octet du parcours
+    size_t          bytes;    // nombre d'octets à écrire
+    size_t          size;     // taille de `bits`
+    unsigned char * opens;    // directions ouvertes à écrire...
+    size_t          low;      // ... à partir de cette profondeur
+    size_t          room;     // taille de `opens`
+};
+
+struct writer snapshotWriter = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                                 PTHREAD_COND_INITIALIZER, false, false, false,
+                                 false, NULL, 0, { {0}, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+                                 NULL, 0, 0, 0, NULL, 0, 0 };
+pthread_once_t snapshotOnce = PTHREAD_ONCE_INIT;
+
+// Contenu du fichier tel que le connaît `snapshot_save`
+struct ledger {
+    char const    * path;                  // fichier décrit
+    struct snapshot slots[SNAPSHOT_SLOTS]; // emplacements, tels qu'écrits
+    unsigned long   epoch;                 // arbre (`memory.epoch`) dont le
+                                           // parcours est écrit (0 : aucun)
+    size_t          written;               // bits du parcours déjà écrits
+    size_t          dirty[SNAPSHOT_SLOTS]; // première profondeur dont les
+                                           // directions ouvertes sont à
+                                           // réécrire dans chaque emplacement
+};
+
+struct ledger snapshotLedger = { NULL, { { {0}, 0, 0, 0, 0, 0, 0, 0, 0, 0 } }, 0, 0, { 0, 0 } };
+
+
+
+/* --- ÉCRITURE ET LECTURE DE BITS --------------------------------------------
+
+ DESCRIPTION :
+    `snapshot_put` écrit les `width` bits de poids faible de `value` à la
+    position `*cursor` (en bits) de `bits`, puis avance le curseur ;
+    `snapshot_get` relit ces bits dans le même ordre.
+ 
+ --------------------------------------------------------------------------- */
+
+void snapshot_put(
+    uint8_t  * const bits,
+    size_t   * const cursor,
+    unsigned   const value,
+    int        const width
+) {
+    
+    int i;
+    
+    for ( i = 0; i < width; i++, (*cursor)++ ) {
+        if ( value >> i & 1 ) {
+            bits[*cursor >> 3] |=   1 << ( *cursor & 7 );
+        } else {
+            bits[*cursor >> 3] &= ~(1 << ( *cursor & 7 ));
+        }
+    }
+}
+
+
+unsigned snapshot_get(
+    uint8_t const * const bits,
+    size_t        * const cursor,
+    int             const width
+) {
+    
+    unsigned value = 0;
+    int      i;
+    
+    for ( i = 0; i < width; i++, (*cursor)++ ) {
+        value |= (unsigned) ( bits[*cursor >> 3] >> ( *cursor & 7 ) & 1 ) << i;
+    }
+    
+    return value;
+}
+
+
+
+/* --- DIRECTIONS OUVERTES D'UN NOEUD QUITTÉ ----------------------------------
+
+ DESCRIPTION :
+    Directions ouvertes d'un noeud sans fiche, ou que Thésée a quitté : ses
+    enfants et son parent.
+ 
+ --------------------------------------------------------------------------- */
+
+unsigned snapshot_open(
+    ExpTree const node
+) {
+    
+    Move const back = move_opposite( node->m );
+    
+    return   ( node->north != NULL ) << North
+           | ( node->east  != NULL ) << East
+           | ( node->south != NULL ) << South
+           | ( node->west  != NULL ) << West
+           | ( back == None ? 0 : 1u << back );
+}
+
+
+
+/* --- CHEMIN VERS THÉSÉE -----------------------------------------------------
+
+ DESCRIPTION :
+    Fonction récursive cherchant Thésée dans un arbre que la mémoire ne
+    couvre pas, et relevant les noeuds du chemin qui y mène (`trail`,
+    agrandi au besoin, indexé par profondeur).
+ 
+ PARAMÈTRES :
+    tree (ExpTree)    : sous-arbre à parcourir ;
+    pos (ExpTree)     : position de Thésée ;
+    depth (size_t)    : profondeur du sous-arbre ;
+    trail (ExpTree **) : noeuds du chemin, alloués une fois Thésée trouvé ;
+    last (size_t *)   : profondeur de Thésée, renseignée si rencontré.
+ 
+ RETOUR :
+    (bool)            : TRUE si Thésée se trouve dans le sous-arbre.
+ 
+ --------------------------------------------------------------------------- */
+
+bool snapshot_locate(
+    ExpTree   const         tree,
+    ExpTree   const         pos,
+     size_t   const         depth,
+    ExpTree       ** const  trail,
+     size_t        * const  last
+) {
+    
+    bool found = tree == pos;
+    
+    if ( found ) {
+        *last  = depth;
+        *trail = malloc( ( depth + 1 ) * sizeof(ExpTree) );
+    } else {
+        found =    ( tree->north && snapshot_locate( tree->north, pos, depth + 1, trail, last ) )
+                || ( tree->east  && snapshot_locate( tree->east , pos, depth + 1, trail, last ) )
+                || ( tree->south && snapshot_locate( tree->south, pos, depth + 1, trail, last ) )
+                || ( tree->west  && snapshot_locate( tree->west , pos, depth + 1, trail, last ) );
+    }
+    
+    if ( found ) {
+        (*trail)[depth] = tree;
+    }
+    
+    return found;
+}
+
+
+
+/* --- ENCODAGE D'UN ARBRE NON COUVERT ----------------------------------------
+
+ DESCRIPTION :
+    Fonction récursive reconstituant le parcours d'un arbre que la mémoire
+    ne couvre pas (voir `snapshot_save`) : les enfants sont parcourus dans
+    l'ordre N, E, S, W, sauf celui qui mène à Thésée, parcouru en dernier et
+    jamais quitté. Un noeud du chemin sans fiche (jamais vu par `theseus`)
+    est supposé ouvert exactement vers ses enfants et son parent.
+ 
+ PARAMÈTRES :
+    tree (ExpTree)         : sous-arbre, dont la descente est déjà écrite ;
+    trail (ExpTree *)      : chemin vers Thésée (NULL hors de ce chemin) ;
+    last (size_t)          : profondeur de Thésée ;
+    depth (size_t)         : profondeur du sous-arbre ;
+    route (struct route *) : parcours reconstitué.
+ 
+ --------------------------------------------------------------------------- */
+
+void snapshot_encode(
+          ExpTree         const tree,
+          ExpTree const * const trail,
+           size_t         const last,
+           size_t         const depth,
+    struct route        * const route
+) {
+    
+    ExpTree const next = trail && depth < last ? trail[depth + 1] : NULL;
+    ExpTree       children[4];
+    int           i;
+    
+    children[0] = tree->north;
+    children[1] = tree->east;
+    children[2] = tree->south;
+    children[3] = tree->west;
+    
+    for ( i = 0; i < 4; i++ ) {
+        if ( children[i] && children[i] != next ) {
+            memory_route_descend( route, tree->m, children[i]->m, snapshot_open( children[i] ) );
+            snapshot_encode( children[i], NULL, 0, depth + 1, route );
+            memory_route_climb( route );
+        }
+    }
+    
+    if ( next ) {
+    
+        struct record const * const rec = memory_find( next );
+    
+        memory_route_descend( route, tree->m, next->m, rec ? rec->open : snapshot_open( next ) );
+        snapshot_encode( next, trail, last, depth + 1, route );
+    }
+}
+
+
+
+/* --- AGRANDISSEMENT DE LA PROJECTION ----------------------------------------
+
+ DESCRIPTION :
+    Agrandit (par doublement) le fichier de sauvegarde et sa projection pour
+    qu'ils couvrent au moins `needed` octets. Le fichier n'est jamais
+    raccourci : les sauvegardes qu'il contient restent intactes.
+ 
+ PARAMÈTRE :
+    needed (size_t) : taille minimale, en octets.
+ 
+ RETOUR :
+    (bool)          : TRUE si la projection couvre `needed` octets.
+ 
+ --------------------------------------------------------------------------- */
+
+bool snapshot_grow(
+    size_t const needed
+) {
+    
+    size_t size = snapshotFile.size ? snapshotFile.size : 4096;
+    
+    if ( needed <= snapshotFile.size ) {
+        return true;
+    }
+    
+    while ( size < needed ) {
+        size *= 2;
+    }
+    
+    if ( snapshotFile.data ) {
+        munmap( snapshotFile.data, snapshotFile.size );
+        snapshotFile.data = NULL;
+        snapshotFile.size = 0;
+    }
+    
+    if ( ftruncate( snapshotFile.fd, size ) ) {
+        return false;
+    }
+    
+    snapshotFile.data = mmap( NULL, size, PROT_READ | PROT_WRITE,
+                              MAP_SHARED, snapshotFile.fd, 0 );
+    
+    if ( snapshotFile.data == MAP_FAILED ) {
+        snapshotFile.data = NULL;
+        return false;
+    }
+    
+    snapshotFile.size = size;
+    return true;
+}
+
+
+
+/* --- ÉCRITURE D'UNE SAUVEGARDE ----------------------------------------------
+
+ DESCRIPTION :
+    Écrit dans le fichier, projeté en mémoire, la sauvegarde préparée par
+    `snapshot_save` : l'emplacement est d'abord invalidé, puis les bits
+    nouveaux du parcours et les directions ouvertes sont écrits et
+    synchronisés, et l'emplacement n'est validé qu'ensuite.
+ 
+ RETOUR :
+    (bool) : TRUE si la sauvegarde a été écrite.
+ 
+ --------------------------------------------------------------------------- */
+
+bool snapshot_write( void ) {
+    
+    struct writer const * const job   = &snapshotWriter;
+    size_t                const page  = sysconf( _SC_PAGESIZE ) > 0 ? sysconf( _SC_PAGESIZE ) : 4096;
+    uint64_t              const route = job->header.route + job->header.routeSize
+                                  , path  = job->header.path  + job->header.pathSize;
+    struct snapshot           * target;
+    uint8_t                   * data;
+    size_t                      cursor;
+    size_t                      start;
+    size_t                      i;
+    
+    // Ouverture (ou changement) du fichier de sauvegarde, projeté en entier
+    // pour y préserver les sauvegardes existantes
+    if ( snapshotFile.path != job->path ) {
+    
+        struct stat info;
+    
+        if ( snapshotFile.data ) {
+            munmap( snapshotFile.data, snapshotFile.size );
+        }
+    
+        if ( snapshotFile.fd >= 0 ) {
+            close( snapshotFile.fd );
+        }
+    
+        snapshotFile.path = job->path;
+        snapshotFile.fd   = open( job->path, O_RDWR | O_CREAT, 0644 );
+        snapshotFile.data = NULL;
+        snapshotFile.size = 0;
+    
+        if ( snapshotFile.fd >= 0 && !fstat( snapshotFile.fd, &info ) && info.st_size > 0 ) {
+    
+            snapshotFile.data = mmap( NULL, info.st_size, PROT_READ | PROT_WRITE,
+                                      MAP_SHARED, snapshotFile.fd, 0 );
+            snapshotFile.size = info.st_size;
+    
+            if ( snapshotFile.data == MAP_FAILED ) {
+                snapshotFile.data = NULL;
+                snapshotFile.size = 0;
+            }
+        }
+    }
+    
+    if (   snapshotFile.fd < 0
+        || !snapshot_grow( page )
+        || !snapshot_grow( route > path ? route : path )
+       ) {
+        return false;
+    }
+    
+    data   = snapshotFile.data;
+    target = &( ( (struct snapshot *) data )[job->slot] );
+    
+    // Invalidation de l'emplacement, dont la zone des directions ouvertes va
+    // être réécrite
+    memset( target->magic, 0, sizeof(target->magic) );
+    msync( data, page, MS_SYNC );
+    
+    memcpy( data + job->header.route + job->from, job->bits, job->bytes );
+    
+    for ( i = job->low; i <= job->header.depth; i++ ) {
+        cursor = 4 * i;
+        snapshot_put( data + job->header.path, &cursor, job->opens[i - job->low], 4 );
+    }
+    
+    start = ( job->header.route + job->from ) / page * page;
+    msync( data + start, job->header.route + job->from + job->bytes - start, MS_SYNC );
+    
+    start = ( job->header.path + job->low / 2 ) / page * page;
+    msync( data + start, job->header.path + job->header.depth / 2 + 1 - start, MS_SYNC );
+    
+    // Validation
+    *target = job->header;
+    memcpy( target->magic, SNAPSHOT_MAGIC, sizeof(target->magic) );
+    msync( data, page, MS_SYNC );
+    
+    return true;
+}
+
+
+
+/* --- THREAD D'ÉCRITURE ------------------------------------------------------
+
+ DESCRIPTION :
+    Boucle du thread d'écriture : il attend qu'une sauvegarde lui soit
+    confiée (`busy`), l'écrit, puis signale qu'il a fini.
+ 
+ --------------------------------------------------------------------------- */
+
+void * snapshot_writer(
+    void * const arg
+) {
+    
+    bool written;
+    
+    (void) arg;
+    pthread_mutex_lock( &(snapshotWriter.lock) );
+    
+    for ( ;; ) {
+    
+        while ( !snapshotWriter.busy ) {
+            pthread_cond_wait( &(snapshotWriter.wake), &(snapshotWriter.lock) );
+        }
+    
+        pthread_mutex_unlock( &(snapshotWriter.lock) );
+    
+        written = snapshot_write();
+    
+        pthread_mutex_lock( &(snapshotWriter.lock) );
+    
+        snapshotWriter.failed = !written;
+        snapshotWriter.busy   = false;
+        pthread_cond_broadcast( &(snapshotWriter.done) );
+    }
+    
+    return NULL;
+}
+
+
+
+/* --- ATTENTE DE L'ÉCRITURE EN COURS -----------------------------------------
+
+ DESCRIPTION :
+    Attend que la dernière sauvegarde confiée au thread d'écriture soit
+    écrite. Appelée avant chaque sauvegarde et restauration, et à la sortie
+    du programme : la dernière sauvegarde n'est donc jamais perdue.
+ 
+ --------------------------------------------------------------------------- */
+
+void snapshot_wait( void ) {
+    
+    pthread_mutex_lock( &(snapshotWriter.lock) );
+    
+    while ( snapshotWriter.busy ) {
+        pthread_cond_wait( &(snapshotWriter.done), &(snapshotWriter.lock) );
+    }
+    
+    pthread_mutex_unlock( &(snapshotWriter.lock) );
+}
+
+
+
+/* --- THREAD D'ÉCRITURE APRÈS UN FORK ----------------------------------------
+
+ DESCRIPTION :
+    Le thread d'écriture ne survit pas à `fork` : le processus enfant repart
+    sans lui, et relit le fichier avant sa première sauvegarde (le parent
+    était peut-être en train de l'écrire).
+ 
+ --------------------------------------------------------------------------- */
+
+void snapshot_forget( void ) {
+    pthread_mutex_init( &(snapshotWriter.lock), NULL );
+    pthread_cond_init( &(snapshotWriter.wake), NULL );
+    pthread_cond_init( &(snapshotWriter.done), NULL );
+    snapshotWriter.busy    = false;
+    snapshotWriter.failed  = true;
+    snapshotWriter.hired   = false;
+    snapshotWriter.running = false;
+}
+
+
+void snapshot_watch( void ) {
+    pthread_atfork( NULL, NULL, snapshot_forget );
+    atexit( snapshot_wait );
+}
+
+
+
+/* --- LANCEMENT DU THREAD D'ÉCRITURE -----------------------------------------
+
+ DESCRIPTION :
+    Lance le thread d'écriture à la première sauvegarde. S'il ne peut être
+    créé, les sauvegardes sont écrites par le thread appelant.
+ 
+ --------------------------------------------------------------------------- */
+
+void snapshot_hire( void ) {
+    
+    pthread_attr_t attr;
+    pthread_t      writer;
+    
+    if ( snapshotWriter.hired ) {
+        return;
+    }
+    
+    pthread_once( &snapshotOnce, snapshot_watch );
+    snapshotWriter.hired = true;
+    
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+    snapshotWriter.running = !pthread_create( &writer, &attr, snapshot_writer, NULL );
+    pthread_attr_destroy( &attr );
+}
+
+
+
+/* --- RELEVÉ DES EMPLACEMENTS ------------------------------------------------
+
+ DESCRIPTION :
+    Relit les emplacements du fichier `path` (s'il existe), à la première
+    sauvegarde dans ce fichier ou après une écriture qui a échoué. Aucun
+    parcours n'y est alors tenu pour écrit.
+ 
+ --------------------------------------------------------------------------- */
+
+void snapshot_survey(
+    char const * const path
+) {
+    
+    int const fd = open( path, O_RDONLY );
+    
+    memset( snapshotLedger.slots, 0, sizeof(snapshotLedger.slots) );
+    
+    if ( fd >= 0 ) {
+    
+        if (   pread( fd, snapshotLedger.slots, sizeof(snapshotLedger.slots), 0 )
+            != (ssize_t) sizeof(snapshotLedger.slots) ) {
+            memset( snapshotLedger.slots, 0, sizeof(snapshotLedger.slots) );
+        }
+    
+        close( fd );
+    }
+    
+    snapshotLedger.path     = path;
+    snapshotLedger.epoch    = 0;
+    snapshotLedger.written  = 0;
+    snapshotLedger.dirty[0] = 0;
+    snapshotLedger.dirty[1] = 0;
+    snapshotWriter.failed   = false;
+}
+
+
+
+/* --- PLACE D'UNE NOUVELLE ZONE ----------------------------------------------
+
+ DESCRIPTION :
+    Fonction cherchant, pour une zone de `size` octets, le plus petit début
+    qui ne recouvre aucune des zones à préserver : juste après la page des
+    emplacements, ou juste après l'une de ces zones (à une limite de page).
+ 
+ PARAMÈTRES :
+    size (uint64_t)    : taille de la zone, en octets ;
+    zones (uint64_t *) : zones à préserver (début puis taille de chacune) ;
+    count (int)        : nombre de zones à préserver ;
+    page (size_t)      : taille d'une page.
+ 
+ RETOUR :
+    (uint64_t)         : début de la zone, en octets.
+ 
+ --------------------------------------------------------------------------- */
+
+uint64_t snapshot_place(
+    uint64_t         const size,
+    uint64_t const * const zones,
+         int         const count,
+      size_t         const page
+) {
+    
+    uint64_t best = UINT64_MAX;
+    uint64_t start;
+    bool     clear;
+    int      i, j;
+    
+    for ( i = -1; i < count; i++ ) {
+    
+        start = i < 0 ? page
+                      : ( zones[2 * i] + zones[2 * i + 1] + page - 1 ) / page * page;
+        clear = start < best;
+    
+        for ( j = 0; clear && j < count; j++ ) {
+            clear = !(   start < zones[2 * j] + zones[2 * j + 1]
+                      && zones[2 * j] < start + size );
+        }
+    
+        if ( clear ) {
+            best = start;
+        }
+    }
+    
+    return best;
+}
+
+
+
+/* --- SAUVEGARDE -------------------------------------------------------------
+
+ DESCRIPTION :
+    Prépare la sauvegarde de l'exploration dans le fichier `path`, en
+    remplacement du plus ancien de ses deux emplacements, puis en confie
+    l'écriture au thread d'écriture.
+    
+    Si la mémoire couvre l'arbre, le parcours est celui qu'elle tient à jour
+    et seuls les bits ajoutés depuis la sauvegarde précédente sont écrits,
+    à la suite de ceux déjà écrits ; les directions ouvertes du chemin ne
+    sont réécrites qu'à partir de la plus faible profondeur atteinte depuis
+    la dernière écriture de l'emplacement. Une sauvegarde coûte ainsi de
+    l'ordre du nombre de pas menés depuis la précédente. Le parcours n'est
+    écrit en entier, dans une nouvelle zone deux fois plus grande, que pour
+    un nouvel arbre ou lorsqu'il a rempli la sienne.
+    
+    Sinon, le parcours est reconstitué à partir de l'arbre (voir
+    `snapshot_encode`) et écrit en entier.
+ 
+ PARAMÈTRES :
+    path (char *)  : fichier de sauvegarde ;
+    map (ExpTree)  : arbre d'exploration ;
+    pos (ExpTree)  : position actuelle de Thésée.
+ 
+ RETOUR :
+    (bool)         : TRUE si la sauvegarde a été confiée au thread
+                     d'écriture, ou écrite s'il n'a pu être lancé.
+ 
+ --------------------------------------------------------------------------- */
+
+bool snapshot_save(
+    char const * const path,
+       ExpTree   const map,
+       ExpTree   const pos
+) {
+    
+    size_t const         page    = sysconf( _SC_PAGESIZE ) > 0 ? sysconf( _SC_PAGESIZE ) : 4096;
+    bool   const         covered =    memory.reliable && !memory.route.broken
+                                   && memory.map == map && memory.last
+                                   && memory.last->node == pos;
+    struct writer      * job     = &snapshotWriter;
+    struct snapshot    * slots   = snapshotLedger.slots;
+    struct route         scratch = { NULL, 0, 0, 0, NULL, 0, 0, 0, false };
+    struct route const * route   = &(memory.route);
+    struct snapshot      header  = { {0}, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    uint64_t             zones[6];
+    size_t               bytes, need;
+    bool                 valid[SNAPSHOT_SLOTS];
+    bool                 fresh;
+    int                  count   = 0;
+    int                  t, i;
+    
+    // L'écriture précédente doit être finie
+    snapshot_hire();
+    snapshot_wait();
+    
+    if ( snapshotLedger.path != path || job->failed ) {
+        snapshot_survey( path );
+    }
+    
+    // Arbre non couvert par la mémoire : parcours reconstitué
+    if ( !covered ) {
+    
+        struct record const * const rec   = memory_find( map );
+        ExpTree                   * trail = NULL;
+        size_t                      last  = 0;
+    
+        if ( !snapshot_locate( map, pos, 0, &trail, &last ) ) {
+            return false;
+        }
+    
+        memory_route_start( &scratch, rec ? rec->open : snapshot_open( map ) );
+        snapshot_encode( map, trail, last, 0, &scratch );
+        free( trail );
+    
+        route = &scratch;
+    }
+    
+    // Emplacement à remplacer : libre, ou le plus ancien (l'autre est alors
+    // celui de la sauvegarde précédente)
+    for ( i = 0; i < SNAPSHOT_SLOTS; i++ ) {
+        valid[i] = !memcmp( slots[i].magic, SNAPSHOT_MAGIC, sizeof(slots[i].magic) );
+    }
+    
+    t = !valid[0] ? 0
+      : !valid[1] ? 1
+      : slots[1].generation < slots[0].generation;
+    
+    if ( valid[1 - t] ) {
+        header.generation = slots[1 - t].generation + 1;
+        zones[count++]    = slots[1 - t].route;
+        zones[count++]    = slots[1 - t].routeSize;
+        zones[count++]    = slots[1 - t].path;
+        zones[count++]    = slots[1 - t].pathSize;
+    }
+    
+    // Parcours : à la suite de celui de la sauvegarde précédente s'il s'agit
+    // du même arbre et qu'il y a la place, dans une nouvelle zone sinon
+    bytes = ( route->length + 7 ) / 8;
+    fresh =    !covered
+            || snapshotLedger.epoch != memory.epoch
+            || !valid[1 - t]
+            || bytes > slots[1 - t].routeSize;
+    
+    if ( fresh ) {
+        header.routeSize = ( 2 * bytes + page ) / page * page;
+        header.route     = snapshot_place( header.routeSize, zones, count / 2, page );
+        job->from        = 0;
+    
+        snapshotLedger.dirty[0] = 0;
+        snapshotLedger.dirty[1] = 0;
+    } else {
+        header.route     = slots[1 - t].route;
+        header.routeSize = slots[1 - t].routeSize;
+        job->from        = snapshotLedger.written / 8;
+    }
+    
+    // Directions ouvertes du chemin : dans la zone propre à l'emplacement, à
+    // partir de la première profondeur qui a changé depuis qu'il a été écrit
+    need = route->depth / 2 + 1;
+    
+    for ( i = 0; i < SNAPSHOT_SLOTS; i++ ) {
+        if ( snapshotLedger.dirty[i] > route->low + 1 ) {
+            snapshotLedger.dirty[i] = route->low + 1;
+        }
+    }
+    
+    if ( !fresh && valid[t] && need <= slots[t].pathSize ) {
+        header.path     = slots[t].path;
+        header.pathSize = slots[t].pathSize;
+        job->low        = snapshotLedger.dirty[t];
+    } else {
+        zones[count++]  = header.route;
+        zones[count++]  = header.routeSize;
+        header.pathSize = ( 2 * need + page ) / page * page;
+        header.path     = snapshot_place( header.pathSize, zones, count / 2, page );
+        job->low        = 0;
+    }
+    
+    // La sauvegarde a lieu avant que l'appel en cours ne soit joué : c'est
+    // lui que la partie reprendra
+    header.steps  = memory.steps > 0 ? memory.steps - 1 : 0;
+    header.nodes  = route->nodes;
+    header.depth  = route->depth;
+    header.length = route->length;
+    
+    // Copie des bits nouveaux et des directions ouvertes à réécrire, que le
+    // thread d'écriture lira pendant que la partie continue
+    job->bytes = bytes - job->from;
+    
+    if ( !job->bits || job->size < job->bytes ) {
+        job->size = job->bytes + 1;
+        job->bits = realloc( job->bits, job->size );
+    }
+    
+    if ( !job->opens || job->room < route->depth + 1 - job->low ) {
+        job->room  = route->depth + 2 - job->low;
+        job->opens = realloc( job->opens, job->room );
+    }
+    
+    memcpy( job->bits, route->bits + job->from, job->bytes );
+    memcpy( job->opens, route->opens + job->low, route->depth + 1 - job->low );
+    
+    job->path   = path;
+    job->slot   = t;
+    job->header = header;
+    
+    // Emplacement tel qu'il sera écrit
+    slots[t] = header;
+    memcpy( slots[t].magic, SNAPSHOT_MAGIC, sizeof(slots[t].magic) );
+    
+    snapshotLedger.epoch    = covered ? memory.epoch : 0;
+    snapshotLedger.written  = route->length;
+    snapshotLedger.dirty[t] = route->depth + 1;
+    
+    if ( covered ) {
+        memory.route.low = memory.route.depth;
+    } else {
+        free( scratch.bits );
+        free( scratch.opens );
+    }
+    
+    if ( !job->running ) {
+        job->failed = !snapshot_write();
+        return !job->failed;
+    }
+    
+    pthread_mutex_lock( &(job->lock) );
+    job->busy = true;
+    pthread_cond_signal( &(job->wake) );
+    pthread_mutex_unlock( &(job->lock) );
+    
+    return true;
+}
+
+
+
+/* --- ABANDON D'UNE RESTAURATION ---------------------------------------------
+
+ DESCRIPTION :
+    Libère les noeuds recréés par une restauration qui a échoué (tous fichés
+    dans la mémoire), puis vide la mémoire.
+ 
+ --------------------------------------------------------------------------- */
+
+void snapshot_discard( void ) {
+    
+    struct record const * tmp;
+    size_t                i;
+    
+    for ( i = 0; i < memory.capacity; i++ ) {
+        for ( tmp = memory.table[i]; tmp; tmp = tmp->bucket ) {
+            free( tmp->node );
+        }
+    }
+    
+    memory_reset( NULL );
+}
+
+
+
+/* --- RESTAURATION D'UN EMPLACEMENT ------------------------------------------
+
+ DESCRIPTION :
+    Vérifie puis rejoue le parcours décrit par l'emplacement `slot`, en
+    recréant l'arbre et la fiche de chaque noeud. Chaque remontée marque le
+    noeud quitté, dont les directions ouvertes sont reconstituées à partir
+    de ses enfants ; celles du chemin vers Thésée sont relues ensuite. La
+    mémoire retrouve ainsi ses rangs d'arrivée et son parcours, que les
+    sauvegardes suivantes prolongeront.
+    
+    Le parcours n'est pas cru sur parole : les zones doivent tenir dans le
+    fichier, aucune descente ne doit mener vers un enfant existant ni
+    dépasser `nodes` noeuds, et le parcours doit finir à la profondeur
+    annoncée en ayant recréé exactement `nodes` noeuds.
+ 
+ PARAMÈTRES :
+    file (uint8_t *)  : projection du fichier de sauvegarde ;
+    size (size_t)     : taille du fichier ;
+    slot (snapshot *) : emplacement à restaurer ;
+    map (ExpTree *)   : arbre d'exploration restauré ;
+    pos (ExpTree *)   : position de Thésée restaurée.
+ 
+ RETOUR :
+    (bool)            : TRUE si l'emplacement était valide et a été restauré.
+ 
+ --------------------------------------------------------------------------- */
+
+bool snapshot_restore(
+            uint8_t const * const file,
+             size_t         const size,
+    struct snapshot const * const slot,
+            ExpTree       * const map,
+            ExpTree       * const pos
+) {
+    
+    uint8_t const * bits;
+    struct record * rec;
+    ExpTree         node;
+    ExpTree       * child;
+    Move            move;
+    size_t          cursor = 0;
+    uint64_t        depth  = 0;
+    bool            valid  = true;
+    
+    if (   memcmp( slot->magic, SNAPSHOT_MAGIC, sizeof(slot->magic) )
+        || slot->route > size
+        || slot->length / 8 >= size - slot->route
+        || slot->path > size
+        || slot->depth / 2 >= size - slot->path
+        || slot->nodes == 0
+        || slot->nodes - 1 > slot->length / 2
+        || slot->depth >= slot->nodes
+       ) {
+        return false;
+    }
+    
+    bits = file + slot->route;
+    
+    memory_reset( NULL );
+    
+    node        = malloc( sizeof(struct Node) );
+    node->m     = None;
+    node->north = NULL;
+    node->east  = NULL;
+    node->south = NULL;
+    node->west  = NULL;
+    rec         = memory_add( node, NULL, 0 );
+    *map        = node;
+    
+    while ( valid && cursor < slot->length ) {
+    
+        Move const from = rec->node->m;
+    
+        if ( from == None ) {
+    
+            // Descente depuis la racine
+            valid = cursor + 2 <= slot->length;
+            move  = valid ? (Move) snapshot_get( bits, &cursor, 2 ) : None;
+    
+        } else if ( !snapshot_get( bits, &cursor, 1 ) ) {
+    
+            // Remontée : le noeud quitté est marqué
+            rec->open = snapshot_open( rec->node );
+            memory_close( rec );
+            rec    = rec->parent;
+            depth -= 1;
+            continue;
+    
+        } else if ( ( valid = cursor < slot->length ) && !snapshot_get( bits, &cursor, 1 ) ) {
+            move = from;
+        } else if ( valid && ( valid = cursor < slot->length ) ) {
+    
+            // Les deux autres directions, dans l'ordre N, E, S, W
+            Move const first = ( from == North || from == South ) ? East : North;
+    
+            move = !snapshot_get( bits, &cursor, 1 ) ? first
+                 : first == East                     ? West : South;
+        } else {
+            move = None;
+        }
+    
+        switch ( move ) {
+            case North: child = &(rec->node->north); break;
+            case East:  child = &(rec->node->east);  break;
+            case South: child = &(rec->node->south); break;
+            case West:  child = &(rec->node->west);  break;
+            default:    child = NULL;                break;
+        }
+    
+        valid = valid && child && !*child && memory.count < slot->nodes;
+    
+        if ( valid ) {
+            node        = malloc( sizeof(struct Node) );
+            node->m     = move;
+            node->north = NULL;
+            node->east  = NULL;
+            node->south = NULL;
+            node->west  = NULL;
+            *child      = node;
+            rec         = memory_add( node, rec, 0 );
+            depth      += 1;
+        }
+    }
+    
+    if ( !valid || memory.count != slot->nodes || depth != slot->depth ) {
+        snapshot_discard();
+        *map = NULL;
+        *pos = NULL;
+        return false;
+    }
+    
+    // Parcours de la mémoire, prolongé par les sauvegardes suivantes
+    memory.route.length = slot->length;
+    memory.route.size   = ( slot->length + 7 ) / 8;
+    memory.route.bits   = malloc( memory.route.size + 1 );
+    memory.route.nodes  = slot->nodes;
+    memory.route.depth  = slot->depth;
+    memory.route.low    = slot->depth;
+    memory.route.room   = slot->depth + 1024;
+    memory.route.opens  = malloc( memory.route.room );
+    memcpy( memory.route.bits, bits, memory.route.size );
+    
+    // Directions ouvertes du chemin vers Thésée
+    *pos = rec->node;
+    
+    for ( ; rec; rec = rec->parent, depth-- ) {
+        cursor    = 4 * depth;
+        rec->open = snapshot_get( file + slot->path, &cursor, 4 );
+        memory.route.opens[depth] = rec->open;
+    }
+    
+    memory.map   = *map;
+    memory.last  = memory_find( *pos );
+    memory.steps = slot->steps;
+    memory.saved = slot->steps + 1;
+    
+    return true;
+}
+
+
+
+/* --- RESTAURATION -----------------------------------------------------------
+
+ DESCRIPTION :
+    Recrée l'arbre d'exploration et la mémoire de Thésée à partir de la plus
+    récente des sauvegardes valides du fichier (la précédente, si la
+    dernière a été interrompue ou est corrompue), après avoir attendu la
+    fin de l'écriture en cours. Il suffit ensuite de reprendre la partie en
+    appelant `theseus` avec l'arbre et la position restaurés : elle ne
+    réécrit pas la sauvegarde qu'elle vient de relire. L'arbre recréé
+    appartient à l'appelant.
+ 
+ PARAMÈTRES :
+    path (char *)  : fichier de sauvegarde ;
+    map (ExpTree *) : arbre d'exploration restauré ;
+    pos (ExpTree *) : position de Thésée restaurée.
+ 
+ RETOUR :
+    (bool)          : TRUE si une sauvegarde complète a été restaurée.
+ 
+ --------------------------------------------------------------------------- */
+
+bool snapshot_load(
+    char const * const path,
+       ExpTree * const map,
+       ExpTree * const pos
+) {
+    
+    int               fd;
+    struct stat       info;
+    struct snapshot * source;
+    bool              restored = false;
+    int               newest;
+    
+    snapshot_wait();
+    
+    fd = open( path, O_RDONLY );
+    
+    if ( fd < 0 ) {
+        return false;
+    }
+    
+    if (   fstat( fd, &info )
+        || (size_t) info.st_size < SNAPSHOT_SLOTS * sizeof(struct snapshot)
+       ) {
+        close( fd );
+        return false;
+    }
+    
+    source = mmap( NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    
+    if ( source == MAP_FAILED ) {
+        return false;
+    }
+    
+    // La plus récente d'abord (un emplacement invalide est refusé d'emblée)
+    newest = source[1].generation > source[0].generation;
+    
+    restored =    snapshot_restore( (uint8_t const *) source, info.st_size,
+                                    &(source[newest]), map, pos )
+               || snapshot_restore( (uint8_t const *) source, info.st_size,
+                                    &(source[1 - newest]), map, pos );
+    
+    munmap( source, info.st_size );
+    
+    return restored;
+}
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs au cache de décisions
+
+ *****************************************************************************/
+
+/* --- SIGNATURES ET CACHE DE DÉCISIONS ---------------------------------------
+
+ DESCRIPTION :
+    La plupart des pas sont évidents (couloir, virage imposé, cul-de-sac),
+    mais paient pourtant l'analyse complète : reconstitution du fil,
+    procédures antiboucle et embuscade. Chaque situation est donc résumée
+    par une signature de 15 bits :
+    
+        - bits 0 à 3   : directions accessibles ;
+        - bits 4 à 7   : enfants existants de la position ;
+        - bits 8 à 11  : cellules voisines déjà connues (voir `memory_known`) ;
+        - bits 12 à 14 : provenance (`pos->m`).
+    
+    Les boucles et les embuscades ne concernent que des cellules connues.
+    La signature décide donc du mouvement si aucune direction candidate
+    (accessible, sans enfant, autre que le demi-tour) ne mène vers une
+    cellule connue : Thésée prend la première candidate selon la politique,
+    ou fait demi-tour s'il n'y en a aucune. Sinon, l'analyse complète reste
+    nécessaire.
+    
+    Ce verdict ne dépend pas de l'orientation : les signatures sont ramenées
+    à une forme canonique parmi leurs 8 images par rotation et symétrie, et
+    le cache (`entries`) retient pour chacune, dès sa première rencontre,
+    soit l'ensemble des mouvements possibles, soit `CACHE_UNDECIDED`.
+    L'ordre de la politique n'est appliqué qu'après retour à l'orientation
+    réelle, si bien que le cache reste valable quand la politique change.
+    
+    Le cache n'est consulté que si la mémoire de Thésée est fiable (les
+    coordonnées des cellules connues en dépendent).
+ 
+ --------------------------------------------------------------------------- */
+
+#define CACHE_SIGNATURES (1 << 15) // nombre de signatures possibles
+#define CACHE_UNDECIDED  0x10      // analyse complète nécessaire
+#define CACHE_DECIDED    0x20      // mouvements possibles dans les bits 0 à 3
+
+struct cache {
+    unsigned char entries[CACHE_SIGNATURES]; // verdicts (0 : jamais vue)
+    long          lookups;                   // signatures consultées
+    long          hits;                      // pas décidés par le cache
+};
+
+struct cache cache = { {0}, 0, 0 };
+
+
+
+/* --- ORIENTATION D'UN MOUVEMENT ---------------------------------------------
+
+ DESCRIPTION :
+    Image d'un mouvement par l'une des 8 transformations du carré : les
+    transformations 0 à 3 sont des rotations d'un quart de tour (dans le
+    sens N, E, S, W), les transformations 4 à 7 des symétries.
+ 
+ PARAMÈTRES :
+    t (int)     : transformation ;
+    move (Move) : mouvement à transformer (`None` est invariant).
+ 
+ RETOUR :
+    (Move)      : mouvement transformé.
+ 
+ --------------------------------------------------------------------------- */
+
+Move cache_turn(
+     int const t,
+    Move const move
+) {
+    
+    if ( move == None ) {
+        return None;
+    }
+    
+    return (Move) ( t < 4 ? ( move + t ) & 3 : ( t - move ) & 3 );
+}
+
+
+
+/* --- TRANSFORMATION RÉCIPROQUE ----------------------------------------------
+
+ --------------------------------------------------------------------------- */
+
+int cache_inverse(
+    int const t
+) {
+    return t < 4 ? ( 4 - t ) & 3 : t;
+}
+
+
+
+/* --- ORIENTATION D'UN MASQUE DE DIRECTIONS ----------------------------------
+
+ --------------------------------------------------------------------------- */
+
+unsigned cache_turn_mask(
+         int const t,
+    unsigned const mask
+) {
+    
+    unsigned result = 0;
+    Move     m;
+    
+    for ( m = North; m <= West; m++ ) {
+        if ( mask & 1 << m ) {
+            result |= 1 << cache_turn( t, m );
+        }
+    }
+    
+    return result;
+}
+
+
+
+/* --- FORME CANONIQUE D'UNE SIGNATURE ----------------------------------------
+
+ DESCRIPTION :
+    La forme canonique est la plus petite des 8 images de la signature.
+ 
+ PARAMÈTRES :
+    signature (unsigned) : signature dans l'orientation réelle ;
+    t (int *)            : transformation menant à la forme canonique.
+ 
+ RETOUR :
+    (unsigned)           : signature canonique.
+ 
+ --------------------------------------------------------------------------- */
+
+unsigned cache_canonical(
+    unsigned const         signature,
+         int       * const t
+) {
+    
+    unsigned best = CACHE_SIGNATURES;
+    int      i;
+    
+    for ( i = 0; i < 8; i++ ) {
+        
+        unsigned const image =   cache_turn_mask( i, signature       & 15 )
+                               | cache_turn_mask( i, signature >> 4  & 15 ) << 4
+                               | cache_turn_mask( i, signature >> 8  & 15 ) << 8
+                               | (unsigned) cache_turn( i, (Move) ( signature >> 12 ) ) << 12;
+        
+        if ( image < best ) {
+            best = image;
+            *t   = i;
+        }
+    }
+    
+    return best;
+}
+
+
+
+/* --- VERDICT D'UNE SIGNATURE ------------------------------------------------
+
+ RETOUR :
+    (unsigned char) : `CACHE_DECIDED` et les mouvements possibles, ou
+                      `CACHE_UNDECIDED`.
+ 
+ --------------------------------------------------------------------------- */
+
+unsigned char cache_classify(
+    unsigned const signature
+) {
+    
+    Move     const from       = (Move) ( signature >> 12 );
+    Move     const back       = move_opposite( from );
+    unsigned const open       = signature      & 15;
+    unsigned const children   = signature >> 4 & 15;
+    unsigned const known      = signature >> 8 & 15;
+    unsigned const candidates = open & ~children & ~( back != None ? 1u << back : 0 );
+    
+    // Cul-de-sac ou intersection entièrement explorée : demi-tour (sauf à la
+    // racine, où la partie s'arrête)
+    if ( !candidates ) {
+        return back != None ? CACHE_DECIDED | 1 << back : CACHE_UNDECIDED;
+    }
+    
+    // Une candidate mène vers une cellule connue : boucle ou embuscade
+    // possible
+    if ( candidates & known ) {
+        return CACHE_UNDECIDED;
+    }
+    
+    return CACHE_DECIDED | candidates;
+}
+
+
+
+/* --- DÉCISION PAR LE CACHE --------------------------------------------------
+
+ PARAMÈTRES :
+    pos (ExpTree)                   : position actuelle de Thésée ;
+    north, east, south, west (bool) : directions accessibles.
+ 
+ RETOUR :
+    (Move)                          : mouvement décidé par la signature, ou
+                                      `None` si l'analyse complète est
+                                      nécessaire.
+ 
+ --------------------------------------------------------------------------- */
+
+Move cache_decide(
+    ExpTree const pos,
+       bool const north,
+       bool const east,
+       bool const south,
+       bool const west
+) {
+    
+    struct record const * const rec = memory.last;
+    unsigned                    signature
+                              , canonical
+                              , moves;
+    unsigned char               entry;
+    int                         t = 0
+                              , i;
+    Move                        m;
+    
+    if ( !cacheMode || !memory.reliable || !rec || rec->node != pos ) {
+        return None;
+    }
+    
+    signature =   north << North | east  << East
+                | south << South | west  << West
+                | (unsigned) pos->m << 12;
+    
+    for ( m = North; m <= West; m++ ) {
+        
+        int x = rec->x
+          , y = rec->y;
+        
+        memory_step( m, &x, &y );
+        
+        if ( move_child( pos, m ) ) {
+            signature |= 1 << ( 4 + m );
+        }
+        
+        if ( memory_known( x, y ) ) {
+            signature |= 1 << ( 8 + m );
+        }
+    }
+    
+    canonical = cache_canonical( signature, &t );
+    cache.lookups++;
+    
+    if ( !cache.entries[canonical] ) {
+        cache.entries[canonical] = cache_classify( canonical );
+    }
+    
+    entry = cache.entries[canonical];
+    
+    if ( !( entry & CACHE_DECIDED ) ) {
+        return None;
+    }
+    
+    // Retour à l'orientation réelle, puis choix selon la politique
+    moves = cache_turn_mask( cache_inverse( t ), entry & 15 );
+    
+    for ( i = 0; i < 4; i++ ) {
+        if ( moves & 1 << policy.order[i] ) {
+            cache.hits++;
+            return policy.order[i];
+        }
+    }
+    
+    return None;
+}
+
+
+
+
+
+/******************************************************************************
+
+    Fonction principale pour le choix du prochain mouvement
+
+ *****************************************************************************/
+
+/* --- ANALYSE COMPLÈTE -------------------------------------------------------
+
+ DESCRIPTION :
+    Choix du prochain mouvement à partir du fil d'Ariane reconstitué, avec
+    les vérifications antiboucle et anti-embuscade. C'est l'analyse menée à
+    chaque pas qui ne suit pas un plan (voir `theseus`).
+ 
+ --------------------------------------------------------------------------- */
+
+Move move_decide(
+    ExpTree const map,      // current exploration tree
+    ExpTree const pos,      // current position in the map exploration tree
+       bool const north,    // can i go North?
+       bool const east,     // can i go East?
+       bool const south,    // can i go South?
+       bool const west      // can i go West?
+) {
+    
+    /* ------------------------------------------------------------------------
+     * Initialisation et déclaration des variables utiles
+     */
+    
+    // Booléens indiquant (i) si le chemin que la fonction s'apprête à renvoyer
+    // ne mène pas vers un chemin déjà visité/une boucle cachée (voir la
+    // procédure `move_prevent_loop`) ; (ii) si on a choisi de faire demi-tour
+    // (voir la suite du programme)
+    bool nextMoveIsATrap = false
+       , hasTurnedAround = false;
+    
+    
+    // Réservation de l'espace mémoire pour (i) le fil d'Ariane ; (ii) un fil
+    // antiboucle (voir procédure `move_prevent_loop`)
+    string const thread     = malloc( sizeof(struct link) )
+               , loopKiller = malloc( sizeof(struct link) );
     
     
     // Prochain mouvement envisagé
-    Move move;
+    Move move = None;
+    
+    
+    // Directions accessibles, indexées par mouvement
+    bool can[5];
+    int  i;
+    
+    can[North] = north;
+    can[East]  = east;
+    can[South] = south;
+    can[West]  = west;
+    can[None]  = false;
     
     
-    // Génération du fil d'Ariane
-    ariane_init( thread, map, pos );
+    // Génération du fil d'Ariane (inutile sans la procédure antiboucle)
+    if ( policy.loopCheck ) {
+        ariane_init( thread, map, pos );
+    } else {
+        thread->m    = None;
+        thread->next = NULL;
+    }
     
     
     // Initialisation du fil d'Ariane temporaire anti-bouclage
@@ -747,7 +3849,9 @@ Move theseus(
     /* ------------------------------------------------------------------------
      * L'exploration de la totalité du donjon accessible nécessite que l'on 
      * parcourt tout l'arbre et ses enfants. On choisit donc comme direction,
-     * dès que possible, le Nord, l'Est, le Sud ou (exclusif) l'Ouest.
+     * dès que possible, la première direction accessible dans l'ordre de
+     * préférence de la politique d'exploration (par défaut le Nord, l'Est,
+     * le Sud ou (exclusif) l'Ouest).
      * 
      * Pour chaque direction cardinale, on vérifie que l'on peut y accéder (à
      * l'aide des paramètres booléens north, east, south et west) et qu'il ne
@@ -762,31 +3866,34 @@ Move theseus(
      * ultérieure, on doit rappeler la fonction theseus.
      */
     
-    if (        !(pos->north) && north && pos->m != South ) {
+    for ( i = 0; i < 4 && move == None; i++ ) {
         
-        move = North;
-        move_prevent_ambush( pos, loopKiller, move, &nextMoveIsATrap );
-        north = false; // on ferme l'accès au Nord
+        Move const direction = policy.order[i];
         
-    } else if ( !(pos->east)  && east  && pos->m != West ) {
-    
-        move = East;
-        move_prevent_ambush( pos, loopKiller, move, &nextMoveIsATrap );
-        east = false; // on ferme l'accès à l'Est
-    
-    } else if ( !(pos->south) && south && pos->m != North ) {
-    
-        move = South;
-        move_prevent_ambush( pos, loopKiller, move, &nextMoveIsATrap );
-        south = false; // on ferme l'accès au Sud
-    
-    } else if ( !(pos->west)  && west  && pos->m != East ) {
+        if (   !move_child( pos, direction )
+            && can[direction]
+            && pos->m != move_opposite( direction )
+           ) {
+            
+            move = direction;
+            
+            // Recherche d'embuscade : simple consultation des fiches de la
+            // cellule visée si la mémoire le permet, sinon parcours du
+            // sous-arbre
+            if ( policy.ambushCheck ) {
+                if ( memory.reliable && memory.last && memory.last->node == pos ) {
+                    nextMoveIsATrap = memory_ambush( memory.last, move );
+                } else {
+                    parallel_prevent_ambush( pos, loopKiller, move, &nextMoveIsATrap, 0 );
+                }
+            }
+            
+            can[direction] = false; // on ferme l'accès à cette direction
+            
+        }
+    }
     
-        move = West;
-        move_prevent_ambush( pos, loopKiller, move, &nextMoveIsATrap );
-        west = false; // on ferme l'accès à l'Ouest
-        
-    } else {
+    if ( move == None ) {
         
         // Dans ce cas là, tous les enfants ont été explorés, donc on remonte
         // toujours vers le parent (demi-tour)
@@ -805,14 +3912,13 @@ Move theseus(
         
         // Si on détecte qu'on aura parcouru une boucle au prochain mouvement,
         // imposer à Thésée de faire demi-tour.
-        if (   move != None
+        if (   policy.loopCheck
+            && move != None
             && ariane_looped( thread, move )
            ) {
             
-            if ( debugMode ) {
-                printf( "\n/!\\ Le prochain mouvement (%d) ramène vers une position déjà\n", move );
-                printf( "    visitée, demi-tour imposé (%d) !\n\n", move_opposite( pos->m ) );
-            }
+            trace_event( TraceLoopDetected, move, 0 );
+            trace_event( TraceUTurn, move_opposite( pos->m ), 0 );
             
             move = move_opposite( pos->m );
         }
@@ -823,11 +3929,8 @@ Move theseus(
         // la fonction actuelle mais en bloquant l'accès vers le chemin 
         // normalement choisi
         if ( nextMoveIsATrap ) {
-            move = theseus( map, pos, north, east, south, west );
-            
-            if ( debugMode ) {
-                printf( "Chemins possibles --\n Nord: %d\n  Est: %d\n  Sud: %d\nOuest: %d\n\n", north, east, south, west );
-            }
+            trace_event( TraceRetry, move, 0 );
+            move = move_decide( map, pos, can[North], can[East], can[South], can[West] );
         }
         
     }
@@ -837,13 +3940,133 @@ Move theseus(
      * Libération des fils d'Ariane puis retour du prochain mouvement choisi.
      */
     
-    free( loopKiller );
-    free( thread );
+    ariane_free( loopKiller );
+    ariane_free( thread );
+    return move;
+    
+}
+
+
+
+/* --- PROCHAIN MOUVEMENT -----------------------------------------------------
+
+ DESCRIPTION :
+    Point d'entrée appelé à chaque pas. Thésée met d'abord sa mémoire à jour,
+    puis suit le plan en cours s'il y en a un et qu'il n'est pas contredit ;
+    sinon, il consulte le cache de décisions (voir `cache_decide`), puis à
+    défaut mène l'analyse complète et, s'il fait demi-tour, planifie la
+    suite du retour en arrière (voir `plan_backtrack`).
+    
+    Sur les longs retours en arrière, chaque pas planifié coûte ainsi une
+    simple lecture de liste au lieu de la reconstitution du fil d'Ariane.
+ 
+ --------------------------------------------------------------------------- */
+
+Move theseus(
+    ExpTree const map,      // current exploration tree
+    ExpTree const pos,      // current position in the map exploration tree
+       bool const north,    // can i go North?
+       bool const east,     // can i go East?
+       bool const south,    // can i go South?
+       bool const west      // can i go West?
+) {
+    
+    Move move;
+    
+    memory_sync( map, pos, north, east, south, west );
+    
+    // Sauvegarde périodique (la mémoire doit couvrir tout l'arbre). Le
+    // premier appel après une restauration est celui qui a été sauvegardé :
+    // il ne réécrit pas la sauvegarde.
+    memory.steps++;
+    if (   snapshotInterval > 0
+        && memory.reliable
+        && memory.steps % snapshotInterval == 0
+        && memory.steps != memory.saved
+       ) {
+        snapshot_save( snapshotPath, map, pos );
+        memory.saved = memory.steps;
+    }
+    
+    traceStep = memory.steps;
+    
+    move = plan_next( pos, north, east, south, west );
+    
+    if ( move == None ) {
+        
+        move = cache_decide( pos, north, east, south, west );
+        
+        if ( move == None ) {
+            move = move_decide( map, pos, north, east, south, west );
+            trace_event( TraceDecision, move, 0 );
+        } else {
+            trace_event( TraceDecision, move, 2 );
+        }
+        
+        plan_backtrack( memory.last, move );
+        
+    } else {
+        trace_event( TraceDecision, move, 1 );
+    }
+    
     return move;
     
 }
 
 
 
+/* --- SÉQUENCE DE MOUVEMENTS -------------------------------------------------
+
+ DESCRIPTION :
+    Variante de `theseus` renvoyant, en plus du prochain mouvement, tous les
+    pas déjà planifiés qui le suivent. Le programme appelant peut jouer la
+    séquence entière sans rappeler l'explorateur, à condition de s'arrêter et
+    de rappeler `theseus` (ou `theseus_plan`) dès qu'un mur contredit le plan.
+    
+    Le fil renvoyé est dans l'ordre de jeu (premier élément = prochain pas),
+    terminé par un élément `None`, et doit être libéré par `ariane_free`.
+ 
+ RETOUR :
+    (string) : séquence de mouvements à jouer.
+ 
+ --------------------------------------------------------------------------- */
+
+string theseus_plan(
+    ExpTree const map,
+    ExpTree const pos,
+       bool const north,
+       bool const east,
+       bool const south,
+       bool const west
+) {
+    
+    string const sequence = malloc( sizeof(struct link) );
+    string       tail     = sequence;
+    string       tmp;
+    
+    sequence->m    = theseus( map, pos, north, east, south, west );
+    sequence->next = NULL;
+    
+    // Copie des pas planifiés à la suite du prochain mouvement
+    for ( tmp = memory.plan; tmp; tmp = tmp->next ) {
+        tail->next = malloc( sizeof(struct link) );
+        tail       = tail->next;
+        tail->m    = tmp->m;
+        tail->next = NULL;
+    }
+    
+    // Terminaison par `None` si aucun plan n'a été recopié
+    if ( tail == sequence && sequence->m != None ) {
+        tail->next       = malloc( sizeof(struct link) );
+        tail->next->m    = None;
+        tail->next->next = NULL;
+    }
+    
+    return sequence;
+    
+}
+
+
+
 
 
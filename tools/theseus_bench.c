@@ -0,0 +1,532 @@
+/*
+ *
+ *
+ *      Projet d'algorithmique 2 - Microbenchmarks de l'explorateur
+ *      Mesure séparément le coût de chaque routine de `theseus_explorer.c`
+ *      sur des arbres d'exploration synthétiques de taille contrôlée.
+ *
+ *
+ *  Compilation (depuis l'environnement décompressé, à côté de `Player/`) :
+ *
+ *      $ gcc -O2 -Wall -IPlayer -o theseus_bench tools/theseus_bench.c -lpthread
+ *      $ ./theseus_bench [nombre_maximal_de_noeuds] > bench.csv
+ *
+ *  Sortie (CSV, une ligne par routine, forme d'arbre et taille) :
+ *
+ *      kernel,shape,nodes,reps,ns_per_op,allocs_per_op
+ *
+ */
+
+#include <stdlib.h>  // malloc, calloc, free, strtol
+#include <stdio.h>   // printf, fprintf
+#include <time.h>    // clock_gettime
+#include <pthread.h> // pthread_create (pile agrandie pour les arbres profonds)
+
+// Compteur d'allocations : toute allocation faite par l'explorateur passe par
+// `bench_malloc` ou `bench_calloc`. Les arbres synthétiques, créés après
+// l'inclusion de l'explorateur, ne sont pas comptés.
+static unsigned long benchAllocs = 0;
+
+static void * bench_malloc( size_t const size ) {
+    benchAllocs++;
+    return malloc( size );
+}
+
+static void * bench_calloc( size_t const count, size_t const size ) {
+    benchAllocs++;
+    return calloc( count, size );
+}
+
+#define malloc( size )        bench_malloc( size )
+#define calloc( count, size ) bench_calloc( count, size )
+#include "theseus_explorer.c"
+#undef malloc
+#undef calloc
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs aux arbres synthétiques
+
+ *****************************************************************************/
+
+/* --- FORMES D'ARBRES --------------------------------------------------------
+
+ DESCRIPTION :
+    Trois formes d'arbres sont générées, toutes suspendues au Nord de la
+    racine (l'Est de la racine reste libre pour l'appel complet à `theseus`) :
+
+    - chain : couloir en zigzag Nord/Est, un seul chemin de n noeuds
+              (profondeur maximale) ;
+    - bushy : arbre construit en largeur, chaque noeud recevant jusqu'à trois
+              enfants (toutes les directions sauf le demi-tour) ;
+    - loops : colonne vertébrale vers le Nord dont chaque noeud porte une
+              boucle carrée (Est, Nord, Ouest) revenant au contact de la
+              colonne, ce qui multiplie les feuilles voisines de cellules
+              connues.
+
+ --------------------------------------------------------------------------- */
+
+enum shape {Chain, Bushy, Loops};
+
+static const char * const shapeNames[] = {"chain", "bushy", "loops"};
+
+
+static ExpTree node_create( Move const m ) {
+    ExpTree const node = calloc( 1, sizeof(struct Node) );
+    node->m = m;
+    return node;
+}
+
+
+static ExpTree * node_child( ExpTree const node, Move const m ) {
+    switch ( m ) {
+        case North: return &(node->north);
+        case East:  return &(node->east);
+        case South: return &(node->south);
+        default:    return &(node->west);
+    }
+}
+
+
+static ExpTree node_append( ExpTree const node, Move const m ) {
+    ExpTree * const child = node_child( node, m );
+    *child = node_create( m );
+    return *child;
+}
+
+
+static ExpTree tree_build( enum shape const shape, long const size ) {
+    ExpTree const root  = node_create( None );
+    ExpTree       tmp   = node_append( root, North );
+    long          count = 2;
+
+    switch ( shape ) {
+        case Chain:
+            while ( count < size ) {
+                tmp = node_append( tmp, count % 2 ? East : North );
+                count++;
+            }
+            break;
+
+        case Bushy: {
+            // File des noeuds à développer (parcours en largeur)
+            ExpTree * const queue = malloc( size * sizeof(ExpTree) );
+            long            head  = 0
+                          , tail  = 0;
+            Move            m;
+
+            queue[tail++] = tmp;
+
+            while ( count < size && head < tail ) {
+                tmp = queue[head++];
+                for ( m = North; m <= West && count < size; m++ ) {
+                    if ( m != move_opposite( tmp->m ) ) {
+                        queue[tail++] = node_append( tmp, m );
+                        count++;
+                    }
+                }
+            }
+
+            free( queue );
+            break;
+        }
+
+        case Loops:
+            while ( count < size ) {
+                ExpTree side = node_append( tmp, East );
+                count++;
+                if ( count < size ) { side = node_append( side, North ); count++; }
+                if ( count < size ) { side = node_append( side, West  ); count++; }
+                if ( count < size ) { tmp  = node_append( tmp,  North ); count++; }
+            }
+            break;
+    }
+
+    return root;
+}
+
+
+static void tree_free( ExpTree const tree ) {
+    if ( tree ) {
+        tree_free( tree->north );
+        tree_free( tree->east  );
+        tree_free( tree->south );
+        tree_free( tree->west  );
+        free( tree );
+    }
+}
+
+
+// Dernier noeud de l'arbre en ordre préfixe : c'est le pire cas pour la
+// recherche de Thésée dans `ariane_generate`.
+static ExpTree tree_last( ExpTree const tree ) {
+    if      ( tree->west  ) return tree_last( tree->west  );
+    else if ( tree->south ) return tree_last( tree->south );
+    else if ( tree->east  ) return tree_last( tree->east  );
+    else if ( tree->north ) return tree_last( tree->north );
+    else                    return tree;
+}
+
+
+static void thread_free( string const thread ) {
+    while ( thread->next ) {
+        ariane_remove( thread );
+    }
+    free( thread );
+}
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs aux parties pas à pas
+
+ *****************************************************************************/
+
+/* --- PARTIE DANS UN ARBRE SYNTHÉTIQUE ---------------------------------------
+
+ DESCRIPTION :
+    Un appel isolé à `theseus` sur un arbre synthétique ne mesure que les
+    parcours de repli : l'arbre n'ayant pas été construit pas à pas, la
+    mémoire de Thésée n'est pas fiable. Une partie joue donc `theseus` à
+    chaque pas, depuis la racine, dans un monde dont l'arbre synthétique
+    donne les passages : en chaque noeud, les directions ouvertes sont ses
+    enfants et le demi-tour. L'arbre d'exploration est construit au fil des
+    mouvements, comme le fait l'environnement.
+
+    Pendant la partie, chaque pas passe par le front d'exploration (analyse
+    complète), les plans de retour en arrière ou le cache de décisions.
+
+ --------------------------------------------------------------------------- */
+
+struct walk {
+    ExpTree   map;    // arbre d'exploration construit pas à pas
+    ExpTree   pos;    // position de Thésée
+    ExpTree * world;  // noeuds du monde le long du chemin actif
+    ExpTree * path;   // noeuds de `map` le long du chemin actif
+    long      depth;  // profondeur de Thésée
+    long      nodes;  // noeuds de `map`
+};
+
+
+static void walk_start( struct walk * const walk, ExpTree const world, long const size ) {
+    walk->map      = node_create( None );
+    walk->pos      = walk->map;
+    walk->world    = malloc( ( size + 1 ) * sizeof(ExpTree) );
+    walk->path     = malloc( ( size + 1 ) * sizeof(ExpTree) );
+    walk->world[0] = world;
+    walk->path[0]  = walk->map;
+    walk->depth    = 0;
+    walk->nodes    = 1;
+}
+
+
+static void walk_stop( struct walk * const walk ) {
+    memory_reset( NULL );
+    tree_free( walk->map );
+    free( walk->world );
+    free( walk->path );
+}
+
+
+// Décision de Thésée à sa position actuelle
+static Move walk_decide( struct walk const * const walk ) {
+    ExpTree const here = walk->world[walk->depth];
+    Move    const back = move_opposite( walk->pos->m );
+
+    return theseus( walk->map, walk->pos,
+                    here->north || back == North, here->east || back == East,
+                    here->south || back == South, here->west || back == West );
+}
+
+
+// Joue le mouvement décidé ; FALSE si la partie est terminée
+static bool walk_apply( struct walk * const walk, Move const move ) {
+    ExpTree const here = walk->world[walk->depth];
+    ExpTree       next;
+
+    if ( move == None ) {
+        return false;
+    }
+
+    if ( walk->depth > 0 && move == move_opposite( walk->pos->m ) ) {
+        walk->pos = walk->path[--(walk->depth)];
+        return true;
+    }
+
+    next = *node_child( here, move );
+
+    if ( !next ) {
+        return false;
+    }
+
+    if ( !move_child( walk->pos, move ) ) {
+        node_append( walk->pos, move );
+        walk->nodes++;
+    }
+
+    walk->pos                   = move_child( walk->pos, move );
+    walk->world[++(walk->depth)] = next;
+    walk->path[walk->depth]     = walk->pos;
+    return true;
+}
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs aux mesures
+
+ *****************************************************************************/
+
+/* --- MESURE D'UNE ROUTINE ---------------------------------------------------
+
+ DESCRIPTION :
+    Chaque routine est appelée au plus `reps` fois, et au moins une fois :
+    les répétitions s'arrêtent dès qu'une seconde de mesure est dépassée,
+    le nombre effectif d'appels est reporté dans la colonne `reps`.
+
+    Seul l'appel lui-même est chronométré (la préparation et la libération
+    des fils ne le sont pas). Le nombre d'allocations est relevé de la même
+    façon.
+
+    Pour `theseus_stepped`, une partie est d'abord jouée jusqu'à avoir
+    découvert la moitié de l'arbre (voir `struct walk`), sans être mesurée ;
+    chaque répétition mesure ensuite le pas suivant de cette partie, au
+    moins 1000 pas si la seconde de mesure le permet. Une partie terminée
+    est recommencée depuis la racine.
+
+    Ces parties ne sont pas sauvegardées, sauf pour
+    `theseus_stepped_snapshot`, qui joue la même partie avec l'intervalle
+    de sauvegarde par défaut de l'explorateur : l'écart entre les deux donne
+    le coût des sauvegardes par pas. Chaque mesure couvre alors au moins
+    quatre intervalles.
+
+ --------------------------------------------------------------------------- */
+
+enum kernel {Generate, Looped, BackToSquareOne, PreventAmbush, Theseus,
+             TheseusStepped, TheseusSnapshot, SnapshotSave, SnapshotLoad};
+
+static const char * const kernelNames[] = {
+    "ariane_generate", "ariane_looped", "ariane_back_to_square_one",
+    "move_prevent_ambush", "theseus", "theseus_stepped",
+    "theseus_stepped_snapshot", "snapshot_save", "snapshot_load"
+};
+
+static const char * const benchSnapshot = "theseus_bench.snapshot";
+
+// Intervalle de sauvegarde par défaut de l'explorateur
+static long benchInterval = 0;
+
+
+static long long now( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+static void bench_kernel(
+    enum kernel const kernel,
+    enum shape  const shape,
+    ExpTree     const root,
+    ExpTree     const target,
+    long        const size,
+    long        const reps
+) {
+    long long     elapsed = 0
+                , start;
+    unsigned long allocs  = 0
+                , before;
+    bool          flag;
+    size_t        depth;
+    long          i;
+    ExpTree       loadedMap = NULL
+                , loadedPos = NULL;
+    Move          move      = None;
+    bool    const stepped   = kernel == TheseusStepped || kernel == TheseusSnapshot;
+    struct walk   walk;
+
+    // Fil d'Ariane de référence (de la racine jusqu'à la cible)
+    string const reference = malloc( sizeof(struct link) );
+    reference->m    = None;
+    reference->next = NULL;
+    flag  = false;
+    depth = 0;
+    ariane_generate( reference, root, target, &flag, &depth );
+
+    // Partie menée jusqu'à mi-parcours (ou pendant 10 secondes au plus), où
+    // les pas seront mesurés
+    if ( kernel == TheseusSnapshot ) {
+        snapshotInterval = benchInterval;
+    }
+
+    if ( stepped ) {
+        start = now();
+        walk_start( &walk, root, size );
+        while (   2 * walk.nodes < size
+               && now() - start < 10000000000LL
+               && walk_apply( &walk, walk_decide( &walk ) ) ) {
+        }
+    }
+
+    for ( i = 0; i < reps && elapsed < 1000000000LL; i++ ) {
+        string const scratch = malloc( sizeof(struct link) );
+        scratch->m    = None;
+        scratch->next = NULL;
+        flag          = false;
+        depth         = 0;
+
+        before = benchAllocs;
+        start  = now();
+
+        switch ( kernel ) {
+            case Generate:
+                ariane_generate( scratch, root, target, &flag, &depth );
+                break;
+
+            case Looped:
+                flag = ariane_looped( reference, North );
+                break;
+
+            case BackToSquareOne:
+                flag = ariane_back_to_square_one( reference, North );
+                break;
+
+            case PreventAmbush:
+                move_prevent_ambush( root, scratch, East, &flag, 0 );
+                break;
+
+            case Theseus:
+                theseus( root, target, true, true, true, true );
+                break;
+
+            case TheseusStepped:
+            case TheseusSnapshot:
+                move = walk_decide( &walk );
+                break;
+
+            case SnapshotSave:
+                snapshot_save( benchSnapshot, root, target );
+                break;
+
+            case SnapshotLoad:
+                snapshot_load( benchSnapshot, &loadedMap, &loadedPos );
+                break;
+        }
+
+        elapsed += now() - start;
+        allocs  += benchAllocs - before;
+
+        thread_free( scratch );
+
+        if ( stepped && !walk_apply( &walk, move ) ) {
+            walk_stop( &walk );
+            walk_start( &walk, root, size );
+        }
+
+        // L'arbre restauré est libéré, et la mémoire qui s'y rapporte oubliée
+        if ( loadedMap ) {
+            memory_reset( NULL );
+            tree_free( loadedMap );
+            loadedMap = NULL;
+        }
+    }
+
+    thread_free( reference );
+
+    if ( stepped ) {
+        walk_stop( &walk );
+    }
+
+    snapshotInterval = 0;
+
+    printf( "%s,%s,%ld,%ld,%.1f,%.2f\n",
+            kernelNames[kernel], shapeNames[shape], size, i,
+            (double) elapsed / i, (double) allocs / i );
+    fflush( stdout );
+}
+
+
+static void * bench_run( void * const arg ) {
+    long const maxSize = *(long *) arg;
+    long       size;
+    enum shape shape;
+    enum kernel kernel;
+
+    // Seule `theseus_stepped_snapshot` sauvegarde ses parties, et jamais
+    // dans le `theseus.snapshot` d'une vraie partie
+    benchInterval    = snapshotInterval;
+    snapshotInterval = 0;
+    snapshotPath     = benchSnapshot;
+
+    printf( "kernel,shape,nodes,reps,ns_per_op,allocs_per_op\n" );
+
+    for ( size = 100; size <= maxSize; size *= 10 ) {
+        for ( shape = Chain; shape <= Loops; shape++ ) {
+
+            ExpTree const root   = tree_build( shape, size );
+            ExpTree const target = tree_last( root );
+
+            // Environ 10^6 noeuds visités par mesure, avec au moins 3 appels
+            long const reps = size < 333334 ? 1000000 / size : 3;
+
+            for ( kernel = Generate; kernel <= SnapshotLoad; kernel++ ) {
+                bench_kernel( kernel, shape, root, target, size,
+                                kernel == TheseusSnapshot && reps < 4 * benchInterval
+                              ? 4 * benchInterval
+                              : kernel == TheseusStepped && reps < 1000 ? 1000 : reps );
+            }
+
+            tree_free( root );
+        }
+    }
+
+    return NULL;
+}
+
+
+
+
+
+/******************************************************************************
+
+    Programme principal
+
+ *****************************************************************************/
+
+int main( int argc, char * argv[] ) {
+
+    long           maxSize = argc > 1 ? strtol( argv[1], NULL, 10 ) : 1000000;
+    pthread_t      worker;
+    pthread_attr_t attr;
+
+    // Journal en mémoire seulement : un `theseus.trace` du répertoire courant
+    // (celui d'une vraie partie) ne doit pas être écrasé
+    tracePath = NULL;
+
+    // Les routines de l'explorateur sont récursives : un couloir de 10^6
+    // noeuds demande une pile bien plus grande que celle par défaut.
+    pthread_attr_init( &attr );
+    pthread_attr_setstacksize( &attr, (size_t) 1 << 30 );
+
+    if ( pthread_create( &worker, &attr, bench_run, &maxSize ) ) {
+        fprintf( stderr, "Impossible de lancer le thread de mesure.\n" );
+        return EXIT_FAILURE;
+    }
+
+    pthread_join( worker, NULL );
+    pthread_attr_destroy( &attr );
+    snapshot_wait();
+    remove( benchSnapshot );
+
+    return EXIT_SUCCESS;
+}
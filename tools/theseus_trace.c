@@ -0,0 +1,149 @@
+/*
+ *
+ *
+ *      Projet d'algorithmique 2 - Décodage du journal d'événements
+ *      Relit le fichier binaire écrit par l'explorateur (`theseus.trace`) et
+ *      affiche en clair les événements de chaque décision.
+ *
+ *
+ *  Compilation (depuis l'environnement décompressé, à côté de `Player/`) :
+ *
+ *      $ gcc -O2 -Wall -IPlayer -o theseus_trace tools/theseus_trace.c -lpthread
+ *      $ ./theseus_trace [theseus.trace]
+ *
+ *  Le journal peut être lu pendant la partie, ou après un arrêt brutal de
+ *  l'explorateur : les anneaux sont écrits directement dans le fichier.
+ *
+ *  Sortie : une ligne par événement, anneau par anneau (un anneau par
+ *  thread), du plus ancien au plus récent :
+ *
+ *      [anneau] temps (µs depuis le premier événement) pas événement
+ *
+ */
+
+#include <stdlib.h>  // malloc, free, EXIT_SUCCESS, EXIT_FAILURE
+#include <stdio.h>   // printf, fopen, fread
+#include <string.h>  // memcmp
+
+#include "theseus_explorer.c"
+
+
+
+static const char * const moveNames[] = {"N", "E", "S", "W", "-"};
+
+
+static const char * move_name( unsigned const move ) {
+    return move <= None ? moveNames[move] : "?";
+}
+
+
+/* --- AFFICHAGE D'UN ÉVÉNEMENT -----------------------------------------------
+
+ DESCRIPTION :
+    Reprend les messages de l'ancien mode de mise au point.
+
+ --------------------------------------------------------------------------- */
+
+static void event_print(
+    int                        const ring,
+    double                     const us,
+    struct trace_event const * const event
+) {
+
+    printf( "[%d] %12.3f us  pas %6u  ", ring, us, event->step );
+
+    switch ( event->type ) {
+        case TraceDecision:
+            printf( "mouvement renvoyé : %s%s\n", move_name( event->move ),
+                    event->arg == 2 ? " (cache)" : event->arg ? " (plan)" : "" );
+            break;
+
+        case TraceThreadRebuilt:
+            printf( "fil d'Ariane reconstitué (%u mouvements%s)\n", event->arg,
+                    event->arg == 65535 ? " ou plus" : "" );
+            break;
+
+        case TraceLoopDetected:
+            printf( "/!\\ le prochain mouvement (%s) ramène vers une position déjà visitée\n",
+                    move_name( event->move ) );
+            break;
+
+        case TraceAmbush:
+            if ( event->arg ) {
+                printf( "/!\\ PROCÉDURE EMBUSCADE ACTIVÉE -- chemin envisagé : %s (feuille à %u pas)\n",
+                        move_name( event->move ), event->arg );
+            } else {
+                printf( "/!\\ PROCÉDURE EMBUSCADE ACTIVÉE -- chemin envisagé : %s\n",
+                        move_name( event->move ) );
+            }
+            break;
+
+        case TraceUTurn:
+            printf( "    demi-tour imposé (%s)\n", move_name( event->move ) );
+            break;
+
+        case TraceRetry:
+            printf( "    nouvel essai, accès fermé vers %s\n", move_name( event->move ) );
+            break;
+
+        default:
+            printf( "événement inconnu (%u)\n", event->type );
+            break;
+    }
+}
+
+
+
+int main( int argc, char * argv[] ) {
+
+    char const * const  path = argc > 1 ? argv[1] : "theseus.trace";
+    FILE       * const  file = fopen( path, "rb" );
+    struct trace_header header;
+    struct trace_ring * buffer;
+    double              nsPerCycle;
+    uint32_t            ring;
+
+    if ( !file ) {
+        fprintf( stderr, "Journal introuvable : %s\n", path );
+        return EXIT_FAILURE;
+    }
+
+    if (   fread( &header, sizeof(header), 1, file ) != 1
+        || memcmp( header.magic, TRACE_MAGIC, sizeof(header.magic) )
+        || header.capacity != TRACE_EVENTS
+       ) {
+        fprintf( stderr, "Journal invalide : %s\n", path );
+        fclose( file );
+        return EXIT_FAILURE;
+    }
+
+    nsPerCycle = header.cyclesEnd > header.cyclesStart
+               ? (double) ( header.nsEnd - header.nsStart ) / ( header.cyclesEnd - header.cyclesStart )
+               : 1.0;
+
+    // Chaque anneau est relu en entier, puis parcouru à partir de son
+    // événement le plus ancien (les anneaux vides n'ont jamais servi)
+    buffer = malloc( sizeof(struct trace_ring) );
+
+    for ( ring = 0; ring < header.rings && fread( buffer, sizeof(struct trace_ring), 1, file ) == 1; ring++ ) {
+
+        uint64_t const head  = atomic_load( &(buffer->head) );
+        uint64_t const first = head > TRACE_EVENTS ? head - TRACE_EVENTS : 0;
+        uint64_t       i;
+
+        if ( first > 0 ) {
+            printf( "[%u] %llu événements plus anciens écrasés\n",
+                    ring, (unsigned long long) first );
+        }
+
+        for ( i = first; i < head; i++ ) {
+            struct trace_event const * const event = &(buffer->events[i & ( TRACE_EVENTS - 1 )]);
+            event_print( ring, ( event->cycles - header.cyclesStart ) * nsPerCycle / 1000.0, event );
+        }
+    }
+
+    free( buffer );
+    fclose( file );
+
+    return EXIT_SUCCESS;
+}
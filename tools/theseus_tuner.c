@@ -0,0 +1,815 @@
+/*
+ *
+ *
+ *      Projet d'algorithmique 2 - Réglage de la politique d'exploration
+ *      Joue chaque politique (ordre de préférence des directions, procédures
+ *      antiboucle et embuscade) sur un corpus de labyrinthes et retient la
+ *      meilleure pour chaque famille de labyrinthes.
+ *
+ *
+ *  Compilation (depuis l'environnement décompressé, à côté de `Player/`) :
+ *
+ *      $ gcc -O2 -Wall -IPlayer -o theseus_tuner tools/theseus_tuner.c -lpthread
+ *      $ ./theseus_tuner [-j processus] [-b pas_maximum] [-g labyrinthes_générés]
+ *                        [-s graine] [-a] [-c] Levels/level*
+ *
+ *  Sortie (CSV) : la meilleure politique de chaque famille (`perfect` : sans
+ *  boucle, `loops` : couloirs avec boucles, `rooms` : salles ouvertes), puis
+ *  la meilleure sur l'ensemble du corpus (`default`). Avec `-a`, toutes les
+ *  politiques sont listées pour chaque famille.
+ *
+ *      class,mazes,order,loop_check,ambush_check,mean_rate,mean_moves_to_full,ns_per_decision
+ *
+ *  Avec `-c`, le réglage est remplacé par un bilan du cache de décisions :
+ *  chaque labyrinthe est joué avec la politique actuelle, sans puis avec le
+ *  cache (`cacheMode`), et l'on compare le temps de décision.
+ *
+ *      class,mazes,decisions,cache_hits,hit_rate,ns_per_decision_uncached,ns_per_decision_cached,time_saved
+ *
+ */
+
+#include <stdlib.h>   // malloc, calloc, free, strtol
+#include <stdio.h>    // printf, fprintf, fopen
+#include <string.h>   // strcspn, strncpy, memset
+#include <time.h>     // clock_gettime
+#include <unistd.h>   // fork, getopt
+#include <sys/mman.h> // mmap (résultats partagés entre processus)
+#include <sys/wait.h> // wait
+
+#include "theseus_explorer.c"
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs aux labyrinthes
+
+ *****************************************************************************/
+
+/* --- LABYRINTHES ------------------------------------------------------------
+
+ DESCRIPTION :
+    Un labyrinthe est une grille de cases libres ('.') et de murs ('*'), dont
+    la case de départ de Thésée est marquée '@', au format des fichiers de
+    `Levels/`. Toute case hors de la grille est un mur.
+
+    Chaque labyrinthe est rangé dans une famille d'après sa forme :
+
+        - rooms   : au moins un carré de 2 x 2 cases libres (salle) ;
+        - loops   : pas de salle, mais au moins une boucle ;
+        - perfect : ni salle ni boucle (un seul chemin entre deux cases).
+
+ --------------------------------------------------------------------------- */
+
+#define MAZE_NAME 64
+
+enum family {Perfect, Loops, Rooms, Families};
+
+static const char * const familyNames[] = {"perfect", "loops", "rooms"};
+
+struct maze {
+    char        name[MAZE_NAME]; // fichier ou description du labyrinthe
+    int         width, height;   // dimensions de la grille
+    char      * cells;           // cases, ligne par ligne
+    int         startX, startY;  // case de départ
+    long        free;            // nombre de cases libres
+    enum family family;          // famille du labyrinthe
+};
+
+
+static bool maze_free_cell( struct maze const * const maze, int const x, int const y ) {
+    return    x >= 0 && x < maze->width
+           && y >= 0 && y < maze->height
+           && maze->cells[y * maze->width + x] != '*';
+}
+
+
+static void maze_step( Move const move, int * const x, int * const y ) {
+    switch ( move ) {
+        case North: (*y)--; break;
+        case East:  (*x)++; break;
+        case South: (*y)++; break;
+        case West:  (*x)--; break;
+        default:            break;
+    }
+}
+
+
+// Famille d'un labyrinthe : les boucles sont détectées par la formule
+// d'Euler (arêtes - cases + composantes > 0), les composantes étant
+// comptées par un parcours en largeur.
+static void maze_classify( struct maze * const maze ) {
+
+    long const size    = (long) maze->width * maze->height;
+    char     * seen    = calloc( size, 1 );
+    long     * queue   = malloc( size * sizeof(long) );
+    long       edges   = 0
+             , parts   = 0;
+    bool       rooms   = false;
+    int        x, y;
+
+    maze->free = 0;
+
+    for ( y = 0; y < maze->height; y++ ) {
+        for ( x = 0; x < maze->width; x++ ) {
+
+            if ( !maze_free_cell( maze, x, y ) ) {
+                continue;
+            }
+
+            maze->free++;
+            edges += maze_free_cell( maze, x + 1, y ) + maze_free_cell( maze, x, y + 1 );
+            rooms  = rooms || (    maze_free_cell( maze, x + 1, y     )
+                                && maze_free_cell( maze, x,     y + 1 )
+                                && maze_free_cell( maze, x + 1, y + 1 ) );
+
+            // Nouvelle composante : parcours en largeur
+            if ( !seen[y * maze->width + x] ) {
+                long head = 0
+                   , tail = 0;
+
+                parts++;
+                seen[y * maze->width + x] = 1;
+                queue[tail++] = y * maze->width + x;
+
+                while ( head < tail ) {
+                    long const cell = queue[head++];
+                    Move       m;
+
+                    for ( m = North; m <= West; m++ ) {
+                        int nx = cell % maze->width
+                          , ny = cell / maze->width;
+
+                        maze_step( m, &nx, &ny );
+
+                        if ( maze_free_cell( maze, nx, ny ) && !seen[ny * maze->width + nx] ) {
+                            seen[ny * maze->width + nx] = 1;
+                            queue[tail++] = ny * maze->width + nx;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    maze->family = rooms                             ? Rooms
+                 : edges - maze->free + parts > 0    ? Loops
+                 :                                     Perfect;
+
+    free( queue );
+    free( seen );
+}
+
+
+/* --- LECTURE D'UN NIVEAU ----------------------------------------------------
+
+ RETOUR :
+    (bool) : TRUE si le fichier a été lu et contient une case de départ.
+
+ --------------------------------------------------------------------------- */
+
+static bool maze_read( struct maze * const maze, char const * const path ) {
+
+    FILE * const file = fopen( path, "r" );
+    char         line[1024];
+    int          y = 0
+               , x;
+
+    if ( !file ) {
+        return false;
+    }
+
+    strncpy( maze->name, path, MAZE_NAME - 1 );
+    maze->name[MAZE_NAME - 1] = '\0';
+    maze->width  = 0;
+    maze->height = 0;
+    maze->startX = -1;
+
+    // Premier passage : dimensions de la grille
+    while ( fgets( line, sizeof(line), file ) ) {
+        int const length = strcspn( line, "\r\n" );
+        maze->width   = length > maze->width ? length : maze->width;
+        maze->height += 1;
+    }
+
+    maze->cells = malloc( (size_t) maze->width * maze->height );
+    memset( maze->cells, '*', (size_t) maze->width * maze->height );
+    rewind( file );
+
+    // Second passage : cases (tout ce qui n'est ni '.' ni '@' est un mur)
+    while ( y < maze->height && fgets( line, sizeof(line), file ) ) {
+        for ( x = 0; line[x] && line[x] != '\r' && line[x] != '\n'; x++ ) {
+            if ( line[x] == '.' || line[x] == '@' ) {
+                maze->cells[y * maze->width + x] = line[x];
+            }
+            if ( line[x] == '@' ) {
+                maze->startX = x;
+                maze->startY = y;
+            }
+        }
+        y++;
+    }
+
+    fclose( file );
+
+    if ( maze->startX < 0 ) {
+        free( maze->cells );
+        return false;
+    }
+
+    maze_classify( maze );
+    return true;
+}
+
+
+/* --- GÉNÉRATION D'UN LABYRINTHE ---------------------------------------------
+
+ DESCRIPTION :
+    Labyrinthe parfait creusé en profondeur sur une grille de `w` x `h`
+    carrefours, puis, selon la famille voulue, percé de passages
+    supplémentaires (boucles) et de salles rectangulaires. La famille
+    effective est ensuite recalculée par `maze_classify`.
+
+ --------------------------------------------------------------------------- */
+
+static unsigned long tunerSeed = 1;
+
+static unsigned long tuner_random( void ) {
+    tunerSeed ^= tunerSeed << 13;
+    tunerSeed ^= tunerSeed >> 7;
+    tunerSeed ^= tunerSeed << 17;
+    return tunerSeed;
+}
+
+
+static void maze_generate(
+    struct maze * const maze,
+    enum family   const family,
+    int           const w,
+    int           const h,
+    int           const index
+) {
+
+    int  * const stack = malloc( (size_t) w * h * sizeof(int) );
+    int          depth = 0
+               , i;
+
+    maze->width  = 2 * w + 1;
+    maze->height = 2 * h + 1;
+    maze->cells  = malloc( (size_t) maze->width * maze->height );
+    memset( maze->cells, '*', (size_t) maze->width * maze->height );
+    snprintf( maze->name, MAZE_NAME, "generated/%s-%d", familyNames[family], index );
+
+    // Creusement en profondeur depuis le carrefour (0, 0)
+    maze->cells[1 * maze->width + 1] = '.';
+    stack[depth++] = 0;
+
+    while ( depth > 0 ) {
+        int const cell = stack[depth - 1];
+        int const cx   = cell % w
+                , cy   = cell / w;
+        Move      next[4];
+        int       count = 0;
+        Move      m;
+
+        for ( m = North; m <= West; m++ ) {
+            int nx = cx
+              , ny = cy;
+            maze_step( m, &nx, &ny );
+            if (   nx >= 0 && nx < w && ny >= 0 && ny < h
+                && maze->cells[(2 * ny + 1) * maze->width + 2 * nx + 1] == '*' ) {
+                next[count++] = m;
+            }
+        }
+
+        if ( count == 0 ) {
+            depth--;
+        } else {
+            int nx = cx
+              , ny = cy;
+            m = next[tuner_random() % count];
+            maze_step( m, &nx, &ny );
+            maze->cells[(cy + ny + 1) * maze->width + cx + nx + 1] = '.';
+            maze->cells[(2 * ny + 1) * maze->width + 2 * nx + 1]   = '.';
+            stack[depth++] = ny * w + nx;
+        }
+    }
+
+    // Boucles : un mur intérieur sur huit est percé
+    if ( family != Perfect ) {
+        for ( i = 0; i < w * h / 8; i++ ) {
+            int const x = 1 + (int) ( tuner_random() % ( maze->width  - 2 ) );
+            int const y = 1 + (int) ( tuner_random() % ( maze->height - 2 ) );
+            if ( ( x + y ) % 2 == 1 ) {
+                maze->cells[y * maze->width + x] = '.';
+            }
+        }
+    }
+
+    // Salles : quelques rectangles entièrement libres
+    if ( family == Rooms ) {
+        for ( i = 0; i < 3; i++ ) {
+            int const rw = 3 + (int) ( tuner_random() % 4 );
+            int const rh = 3 + (int) ( tuner_random() % 3 );
+            int const rx = 1 + (int) ( tuner_random() % ( maze->width  - rw - 1 ) );
+            int const ry = 1 + (int) ( tuner_random() % ( maze->height - rh - 1 ) );
+            int       x, y;
+
+            for ( y = ry; y < ry + rh; y++ ) {
+                for ( x = rx; x < rx + rw; x++ ) {
+                    maze->cells[y * maze->width + x] = '.';
+                }
+            }
+        }
+    }
+
+    maze->startX = 1;
+    maze->startY = 1;
+    maze->cells[1 * maze->width + 1] = '@';
+
+    free( stack );
+    maze_classify( maze );
+}
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs aux parties simulées
+
+ *****************************************************************************/
+
+/* --- PARTIE SIMULÉE ---------------------------------------------------------
+
+ DESCRIPTION :
+    Joue une partie comme le programme `dedalus_explorer` : à chaque pas,
+    `theseus` reçoit l'arbre d'exploration, la position et les directions
+    libres ; un demi-tour ramène au noeud parent, tout autre mouvement crée
+    un enfant. La partie s'arrête quand Thésée renvoie `None`, heurte un mur
+    ou a épuisé ses `budget` pas.
+
+    La mémoire de l'explorateur est vidée à la fin de chaque partie : le
+    noeud racine de la partie suivante pourrait sinon réutiliser l'adresse
+    de celui-ci et passer pour le même arbre.
+
+ --------------------------------------------------------------------------- */
+
+struct outcome {
+    long     moves;       // pas joués
+    long     movesToFull; // pas nécessaires pour tout explorer (-1 : jamais)
+    int      rate;        // taux d'exploration final (en %)
+    long     decisions;   // appels à `theseus`
+    long     hits;        // pas décidés par le cache de décisions
+    double   ns;          // temps total passé dans `theseus`
+    uint64_t route;       // empreinte de la suite des mouvements (FNV-1a)
+};
+
+
+static long long now( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (long long) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+static void tree_free( ExpTree const tree ) {
+    if ( tree ) {
+        tree_free( tree->north );
+        tree_free( tree->east  );
+        tree_free( tree->south );
+        tree_free( tree->west  );
+        free( tree );
+    }
+}
+
+
+static struct outcome game_play( struct maze const * const maze, long const budget ) {
+
+    struct outcome  result  = { 0, -1, 0, 0, 0, 0, 14695981039346656037u };
+    char    * const visited = calloc( (size_t) maze->width * maze->height, 1 );
+    ExpTree * const parents = malloc( ( budget + 1 ) * sizeof(ExpTree) );
+    ExpTree   const map     = calloc( 1, sizeof(struct Node) );
+    ExpTree         pos     = map;
+    long            depth   = 0
+                  , seen    = 1
+                  , hits    = cache.hits;
+    int             x       = maze->startX
+                  , y       = maze->startY;
+
+    map->m = None;
+    visited[y * maze->width + x] = 1;
+
+    while ( result.moves < budget ) {
+
+        long long const start = now();
+        Move      const move  = theseus( map, pos,
+                                         maze_free_cell( maze, x, y - 1 ),
+                                         maze_free_cell( maze, x + 1, y ),
+                                         maze_free_cell( maze, x, y + 1 ),
+                                         maze_free_cell( maze, x - 1, y ) );
+        int             nx    = x
+                      , ny    = y;
+
+        result.ns += now() - start;
+        result.decisions++;
+        result.route = ( result.route ^ (uint64_t) move ) * 1099511628211u;
+
+        maze_step( move, &nx, &ny );
+
+        if ( move == None || !maze_free_cell( maze, nx, ny ) ) {
+            break;
+        }
+
+        result.moves++;
+        x = nx;
+        y = ny;
+
+        // Mise à jour de l'arbre d'exploration
+        if ( depth > 0 && move == move_opposite( pos->m ) ) {
+            pos = parents[--depth];
+        } else {
+            ExpTree child = move_child( pos, move );
+
+            if ( !child ) {
+                child = calloc( 1, sizeof(struct Node) );
+                child->m = move;
+                switch ( move ) {
+                    case North: pos->north = child; break;
+                    case East:  pos->east  = child; break;
+                    case South: pos->south = child; break;
+                    default:    pos->west  = child; break;
+                }
+            }
+
+            parents[depth++] = pos;
+            pos = child;
+        }
+
+        if ( !visited[y * maze->width + x] ) {
+            visited[y * maze->width + x] = 1;
+            seen++;
+
+            if ( seen == maze->free ) {
+                result.movesToFull = result.moves;
+            }
+        }
+    }
+
+    result.rate = (int) ( 100 * seen / maze->free );
+    result.hits = cache.hits - hits;
+
+    memory_reset( NULL );
+    tree_free( map );
+    free( parents );
+    free( visited );
+
+    return result;
+}
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs au réglage
+
+ *****************************************************************************/
+
+/* --- POLITIQUES ESSAYÉES ----------------------------------------------------
+
+ DESCRIPTION :
+    Les 24 ordres de préférence des directions, chacun avec ou sans la
+    procédure antiboucle et avec ou sans la procédure embuscade, soit 96
+    politiques. La politique d'indice 0 est celle par défaut (N, E, S, W avec
+    les deux procédures).
+
+ --------------------------------------------------------------------------- */
+
+#define POLICIES 96
+
+static struct policy policy_get( int const index ) {
+
+    static int const factorial[] = {6, 2, 1, 1};
+
+    struct policy result;
+    Move          remaining[4] = {North, East, South, West};
+    int           perm         = index / 4
+                , i, j;
+
+    // Décodage de la permutation (numération factorielle)
+    for ( i = 0; i < 4; i++ ) {
+        j     = perm / factorial[i];
+        perm %= factorial[i];
+        result.order[i] = remaining[j];
+        for ( ; j < 3 - i; j++ ) {
+            remaining[j] = remaining[j + 1];
+        }
+    }
+
+    result.loopCheck   = !( index & 1 );
+    result.ambushCheck = !( index & 2 );
+
+    return result;
+}
+
+
+/* --- SCORE D'UNE POLITIQUE --------------------------------------------------
+
+ DESCRIPTION :
+    Une politique est jugée, sur un ensemble de labyrinthes, d'abord par son
+    taux d'exploration moyen (le plus haut possible), puis par le nombre
+    moyen de pas nécessaires pour tout explorer (une exploration incomplète
+    compte pour le budget entier), enfin par le temps moyen de décision.
+
+ --------------------------------------------------------------------------- */
+
+struct score {
+    int    policy;    // indice de la politique
+    int    mazes;     // nombre de labyrinthes joués
+    double rate;      // taux d'exploration moyen
+    double moves;     // pas moyens pour tout explorer
+    double ns;        // temps moyen par décision
+};
+
+
+static struct score score_get(
+    struct outcome const * const results,
+    struct maze    const * const mazes,
+    int                    const count,
+    int                    const policy,
+    int                    const family, // -1 : toutes les familles
+    long                   const budget
+) {
+
+    struct score score     = { policy, 0, 0, 0, 0 };
+    double       decisions = 0;
+    int          i;
+
+    for ( i = 0; i < count; i++ ) {
+        if ( family < 0 || (int) mazes[i].family == family ) {
+            struct outcome const * const r = &results[policy * count + i];
+            score.mazes++;
+            score.rate  += r->rate;
+            score.moves += r->movesToFull >= 0 ? r->movesToFull : budget;
+            score.ns    += r->ns;
+            decisions   += r->decisions;
+        }
+    }
+
+    if ( score.mazes ) {
+        score.rate  /= score.mazes;
+        score.moves /= score.mazes;
+        score.ns     = decisions > 0 ? score.ns / decisions : 0;
+    }
+
+    return score;
+}
+
+
+static bool score_better( struct score const a, struct score const b ) {
+    if ( a.rate  != b.rate  ) return a.rate  > b.rate;
+    if ( a.moves != b.moves ) return a.moves < b.moves;
+    return a.ns < b.ns;
+}
+
+
+static void score_print( char const * const name, struct score const score ) {
+
+    struct policy const p       = policy_get( score.policy );
+    char const          names[] = "NESW";
+
+    printf( "%s,%d,%c%c%c%c,%d,%d,%.1f,%.1f,%.1f\n",
+            name, score.mazes,
+            names[p.order[0]], names[p.order[1]], names[p.order[2]], names[p.order[3]],
+            p.loopCheck, p.ambushCheck, score.rate, score.moves, score.ns );
+}
+
+
+
+
+
+/******************************************************************************
+
+    Ensemble de modules relatifs au cache de décisions
+
+ *****************************************************************************/
+
+/* --- BILAN DU CACHE ---------------------------------------------------------
+
+ DESCRIPTION :
+    Joue chaque labyrinthe avec la politique actuelle, sans puis avec le
+    cache de décisions, et affiche pour chaque famille (puis pour tout le
+    corpus, `all`) la part des pas décidés par le cache et le temps moyen de
+    décision dans les deux cas. Les deux parties doivent être identiques,
+    mouvement pour mouvement (même empreinte `route`) : une différence est
+    signalée sur la sortie d'erreur.
+
+ --------------------------------------------------------------------------- */
+
+static int cache_report(
+    struct maze const * const mazes,
+    int                 const count,
+    long                const budget
+) {
+
+    struct outcome * const uncached = malloc( count * sizeof(struct outcome) );
+    struct outcome * const cached   = malloc( count * sizeof(struct outcome) );
+    int                    status   = EXIT_SUCCESS
+                         , i, f;
+
+    for ( i = 0; i < count; i++ ) {
+
+        cacheMode   = false;
+        uncached[i] = game_play( &mazes[i], budget );
+        cacheMode   = true;
+        cached[i]   = game_play( &mazes[i], budget );
+
+        if (   uncached[i].moves       != cached[i].moves
+            || uncached[i].movesToFull != cached[i].movesToFull
+            || uncached[i].rate        != cached[i].rate
+            || uncached[i].route       != cached[i].route
+           ) {
+            fprintf( stderr, "Partie différente avec le cache : labyrinthe %d\n", i );
+            status = EXIT_FAILURE;
+        }
+    }
+
+    printf( "class,mazes,decisions,cache_hits,hit_rate,ns_per_decision_uncached,ns_per_decision_cached,time_saved\n" );
+
+    for ( f = Perfect; f <= Families; f++ ) {
+
+        int    mazesCount = 0;
+        long   decisions  = 0
+             , hits       = 0;
+        double before     = 0
+             , after      = 0;
+
+        for ( i = 0; i < count; i++ ) {
+            if ( f == Families || (int) mazes[i].family == f ) {
+                mazesCount++;
+                decisions += cached[i].decisions;
+                hits      += cached[i].hits;
+                before    += uncached[i].ns;
+                after     += cached[i].ns;
+            }
+        }
+
+        if ( mazesCount == 0 || decisions == 0 ) {
+            continue;
+        }
+
+        printf( "%s,%d,%ld,%ld,%.1f%%,%.1f,%.1f,%.1f%%\n",
+                f < Families ? familyNames[f] : "all", mazesCount, decisions, hits,
+                100.0 * hits / decisions, before / decisions, after / decisions,
+                before > 0 ? 100.0 * ( before - after ) / before : 0 );
+    }
+
+    free( uncached );
+    free( cached );
+
+    return status;
+}
+
+
+
+
+
+/******************************************************************************
+
+    Programme principal
+
+ *****************************************************************************/
+
+/* --- RÉGLAGE EN PARALLÈLE ---------------------------------------------------
+
+ DESCRIPTION :
+    Les politiques sont réparties entre `jobs` processus. On utilise des
+    processus plutôt que des threads car l'explorateur garde son état (sa
+    mémoire, son plan, sa politique) dans des variables globales. Chaque
+    processus écrit ses résultats dans une zone de mémoire partagée.
+
+ --------------------------------------------------------------------------- */
+
+int main( int argc, char * argv[] ) {
+
+    long             jobs      = sysconf( _SC_NPROCESSORS_ONLN ) > 0
+                               ? sysconf( _SC_NPROCESSORS_ONLN ) : 1;
+    long             budget    = 10000;
+    int              generated = 4
+                   , all       = 0
+                   , report    = 0
+                   , count     = 0
+                   , option
+                   , i, f, w;
+    struct maze    * mazes;
+    struct outcome * results;
+
+    while ( ( option = getopt( argc, argv, "j:b:g:s:ac" ) ) != -1 ) {
+        switch ( option ) {
+            case 'j': jobs      = strtol( optarg, NULL, 10 ); break;
+            case 'b': budget    = strtol( optarg, NULL, 10 ); break;
+            case 'g': generated = (int) strtol( optarg, NULL, 10 ); break;
+            case 's': tunerSeed = strtoul( optarg, NULL, 10 ) | 1; break;
+            case 'a': all       = 1; break;
+            case 'c': report    = 1; break;
+            default:
+                fprintf( stderr, "Usage: %s [-j jobs] [-b budget] [-g generated] [-s seed] [-a] [-c] level...\n", argv[0] );
+                return EXIT_FAILURE;
+        }
+    }
+
+    jobs  = jobs > 0 ? jobs : 1;
+    mazes = malloc( ( argc - optind + Families * generated ) * sizeof(struct maze) );
+
+    // Corpus : niveaux donnés en paramètre puis labyrinthes générés
+    for ( i = optind; i < argc; i++ ) {
+        if ( maze_read( &mazes[count], argv[i] ) ) {
+            count++;
+        } else {
+            fprintf( stderr, "Niveau illisible : %s\n", argv[i] );
+        }
+    }
+
+    for ( f = Perfect; f < Families; f++ ) {
+        for ( i = 0; i < generated; i++ ) {
+            maze_generate( &mazes[count++], (enum family) f, 12 + 4 * i, 8 + 2 * i, i );
+        }
+    }
+
+    if ( count == 0 ) {
+        fprintf( stderr, "Aucun labyrinthe à explorer.\n" );
+        return EXIT_FAILURE;
+    }
+
+    // Ni sauvegarde, ni journal pendant le réglage (les processus de réglage
+    // écriraient tous dans le même fichier de journal)
+    snapshotInterval = 0;
+    tracePath        = NULL;
+
+    if ( report ) {
+        return cache_report( mazes, count, budget );
+    }
+
+    results = mmap( NULL, (size_t) POLICIES * count * sizeof(struct outcome),
+                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+
+    if ( results == MAP_FAILED ) {
+        fprintf( stderr, "Impossible de partager les résultats.\n" );
+        return EXIT_FAILURE;
+    }
+
+    for ( w = 0; w < jobs; w++ ) {
+        if ( fork() == 0 ) {
+            int p;
+            for ( p = w; p < POLICIES; p += jobs ) {
+                policy = policy_get( p );
+                for ( i = 0; i < count; i++ ) {
+                    results[p * count + i] = game_play( &mazes[i], budget );
+                }
+            }
+            _exit( EXIT_SUCCESS );
+        }
+    }
+
+    while ( wait( NULL ) > 0 ) {
+        ;
+    }
+
+    // Meilleure politique par famille, puis sur l'ensemble du corpus
+    printf( "class,mazes,order,loop_check,ambush_check,mean_rate,mean_moves_to_full,ns_per_decision\n" );
+
+    for ( f = Perfect; f <= Families; f++ ) {
+
+        int          const family = f < Families ? f : -1;
+        char const * const name   = f < Families ? familyNames[f] : "default";
+        struct score       best   = score_get( results, mazes, count, 0, family, budget );
+        int                p;
+
+        if ( best.mazes == 0 ) {
+            continue;
+        }
+
+        for ( p = 0; p < POLICIES; p++ ) {
+            struct score const score = score_get( results, mazes, count, p, family, budget );
+
+            if ( all ) {
+                score_print( name, score );
+            }
+
+            if ( score_better( score, best ) ) {
+                best = score;
+            }
+        }
+
+        if ( !all ) {
+            score_print( name, best );
+        }
+    }
+
+    return EXIT_SUCCESS;
+}